@@ -0,0 +1,354 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file arithcoder.h
+ * @brief Arithmetic decoder and encoder working on the bit parser and bit buffer.
+ */
+
+#pragma once
+
+// System includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Internal includes
+#include "ilo/bitparser.h"
+#include "ilo/bitbuffer.h"
+
+namespace ilo {
+namespace impl {
+//! Number of bits of the arithmetic coder interval
+static const uint32_t kArithRangeBits = 16u;
+//! Precision of the cumulative frequency tables of the arithmetic coder
+static const uint32_t kArithFreqBits = 14u;
+
+//! Renormalization shifts of an arithmetic coder interval
+struct SArithRenorm {
+  //! Number of leading bits low and high have in common (emitted bits)
+  uint32_t leadingBits;
+  //! Number of underflow shifts following the leading bits (low = 01..., high = 10...)
+  uint32_t underflowBits;
+};
+
+/*!
+ * @brief Computes all renormalization shifts of the interval [low, high] at once
+ *
+ * The bit-serial renormalization loop of the MPEG-H arithmetic coder first shifts out the leading
+ * bits low and high have in common and then the underflow bits. Both counts follow from the bit
+ * patterns of low and high, so the whole loop can be done in one step.
+ */
+inline SArithRenorm arithRenorm(uint32_t low, uint32_t high) {
+  SArithRenorm renorm = {0u, 0u};
+  if (((low ^ high) & 0x8000u) != 0 && (low < 0x4000u || high >= 0xC000u)) {
+    // most frequent case: the interval is wide enough
+    return renorm;
+  }
+  // at most 16 leading bits, the guard bit stops the count for low == high
+  renorm.leadingBits =
+      countLeadingZeros64((uint64_t{low ^ high} << 48u) | (uint64_t{1} << 47u));
+  uint32_t fill = (1u << renorm.leadingBits) - 1u;
+  low = (low << renorm.leadingBits) & 0xFFFFu;
+  high = ((high << renorm.leadingBits) | fill) & 0xFFFFu;
+  // count the pairs low bit = 1, high bit = 0 following the (differing) first bit
+  uint32_t underflowPattern = ((low & ~high) << 1u) & 0xFFFFu;
+  renorm.underflowBits = countLeadingZeros64(uint64_t{~underflowPattern & 0xFFFFu} << 48u);
+  return renorm;
+}
+
+/*!
+ * @brief Applies the renormalization shifts to a 16 bit interval bound or code value
+ *
+ * @param word The interval bound or code value
+ * @param renorm The shifts computed by arithRenorm
+ * @param newBits The leadingBits + underflowBits bits shifted in
+ */
+inline uint32_t arithShift(uint32_t word, const SArithRenorm& renorm, uint32_t newBits) {
+  word = ((word << renorm.leadingBits) | (newBits >> renorm.underflowBits)) & 0xFFFFu;
+  uint32_t underflowMask = (1u << renorm.underflowBits) - 1u;
+  return (word & 0x8000u) | ((word << renorm.underflowBits) & 0x7FFFu) | (newBits & underflowMask);
+}
+}  // namespace impl
+
+/*!
+ * @brief Arithmetic decoder of the MPEG-H 3D Audio / USAC spectral noiseless coding
+ *
+ * Decodes symbols with the 16 bit arithmetic decoder of ISO/IEC 23008-3 / ISO/IEC 23003-3 from a
+ * bit parser. The probability models are tables of decreasing cumulative frequencies with 14 bit
+ * precision: cumFreq[s] is the lower bound of symbol s, the upper bound of symbol 0 is 16384 and
+ * the last entry is 0.
+ *
+ * In contrast to the bit-serial reference decoder, the renormalization shifts are computed from
+ * the interval bounds and all new bits are taken from the parser's cache register with one read.
+ *
+ * The decoder reads 16 bits ahead. Call @ref finish after the last symbol to move the parser to
+ * the end of the arithmetic coded data.
+ *
+ * @code
+ * ilo::CArithDecoder decoder(parser);
+ * for (auto& q : quantizedValues) {
+ *   q = decoder.decode(cumFreqTables[context], nofSymbols[context]);
+ * }
+ * decoder.finish();
+ * @endcode
+ *
+ * @tparam ParserT Bit parser to read from, ilo::CBitParser or ilo::CBitParser64
+ *
+ * \ingroup bittools
+ */
+template <typename ParserT>
+class CBasicArithDecoder {
+ public:
+  /*!
+   * @brief Create decoder and read the first 16 bits of the code value
+   *
+   * @param parser The parser positioned at the start of the arithmetic coded data. It must not be
+   * used until @ref finish was called.
+   */
+  explicit CBasicArithDecoder(ParserT& parser);
+
+  //! Disallow copy constructor
+  CBasicArithDecoder(const CBasicArithDecoder& copyDecoder) = delete;
+
+  //! Disallow assignment operator
+  CBasicArithDecoder& operator=(const CBasicArithDecoder& copyDecoder) = delete;
+
+  /*!
+   * @brief Function to decode a symbol
+   *
+   * @param cumFreq Decreasing cumulative frequencies of the symbols, ending with 0
+   * @param nofSymbols Number of entries of cumFreq
+   * @return Index of the decoded symbol
+   */
+  uint32_t decode(const uint16_t* cumFreq, uint32_t nofSymbols) {
+    uint32_t range = m_high - m_low + 1u;
+    uint32_t cum = (((m_value - m_low + 1u) << impl::kArithFreqBits) - 1u) / range;
+    // the symbol is the first one whose lower bound is not above cum
+    const uint16_t* found = std::lower_bound(cumFreq, cumFreq + nofSymbols - 1u, cum,
+                                             [](uint16_t freq, uint32_t c) { return freq > c; });
+    uint32_t symbol = static_cast<uint32_t>(found - cumFreq);
+
+    if (symbol > 0) {
+      m_high = m_low + ((range * cumFreq[symbol - 1u]) >> impl::kArithFreqBits) - 1u;
+    }
+    m_low += (range * cumFreq[symbol]) >> impl::kArithFreqBits;
+
+    impl::SArithRenorm renorm = impl::arithRenorm(m_low, m_high);
+    uint32_t nofNewBits = renorm.leadingBits + renorm.underflowBits;
+    if (nofNewBits != 0) {
+      uint32_t newBits = 0;
+      if (!m_parser.tryRead(newBits, nofNewBits)) {
+        newBits = readPadded(nofNewBits);
+      }
+      m_low = impl::arithShift(m_low, renorm, 0u);
+      m_high = impl::arithShift(m_high, renorm, (1u << nofNewBits) - 1u);
+      m_value = impl::arithShift(m_value, renorm, newBits);
+    }
+    return symbol;
+  }
+
+  /*!
+   * @brief Function to finish decoding
+   *
+   * Moves the parser back by the bits read ahead, so it is positioned right behind the arithmetic
+   * coded data. Reports ilo::EBitError::endOfData through the parser if the data was truncated.
+   */
+  void finish();
+
+ private:
+  //! Reads nnofBits bits, padding with zeros behind the end of the data
+  uint32_t readPadded(uint32_t nnofBits);
+
+  //! The parser to read from
+  ParserT& m_parser;
+  //! Lower bound of the interval
+  uint32_t m_low;
+  //! Upper bound of the interval
+  uint32_t m_high;
+  //! Current 16 bit window of the code value
+  uint32_t m_value;
+  //! Number of zero bits read behind the end of the data
+  uint32_t m_nofPaddingBits;
+};
+
+/*!
+ * @brief Arithmetic encoder of the MPEG-H 3D Audio / USAC spectral noiseless coding
+ *
+ * Counterpart of ilo::CBasicArithDecoder, see there for the format of the frequency tables. The
+ * renormalization is done in one step per symbol: the emitted bits and the pending carry bits
+ * (bits to follow) are combined into a single write into the bit buffer.
+ *
+ * @tparam BufferT Bit buffer to write to, ilo::CBitBuffer or ilo::CBitBuffer64
+ *
+ * \ingroup bittools
+ */
+template <typename BufferT>
+class CBasicArithEncoder {
+ public:
+  //! Create encoder which writes at the current write position of buffer
+  explicit CBasicArithEncoder(BufferT& buffer);
+
+  //! Disallow copy constructor
+  CBasicArithEncoder(const CBasicArithEncoder& copyEncoder) = delete;
+
+  //! Disallow assignment operator
+  CBasicArithEncoder& operator=(const CBasicArithEncoder& copyEncoder) = delete;
+
+  /*!
+   * @brief Function to encode a symbol
+   *
+   * @param symbol Index of the symbol
+   * @param cumFreq Decreasing cumulative frequencies of the symbols, ending with 0
+   *
+   * @note Symbols with a frequency of 0 are rejected with a std::invalid_argument exception.
+   */
+  void encode(uint32_t symbol, const uint16_t* cumFreq) {
+    uint32_t range = m_high - m_low + 1u;
+    uint32_t upper = symbol > 0 ? cumFreq[symbol - 1u] : (1u << impl::kArithFreqBits);
+    if (upper <= cumFreq[symbol]) {
+      zeroFrequency();
+    }
+    m_high = m_low + ((range * upper) >> impl::kArithFreqBits) - 1u;
+    m_low += (range * cumFreq[symbol]) >> impl::kArithFreqBits;
+
+    impl::SArithRenorm renorm = impl::arithRenorm(m_low, m_high);
+    if (renorm.leadingBits != 0) {
+      writeBits(m_low >> (impl::kArithRangeBits - renorm.leadingBits), renorm.leadingBits);
+    }
+    m_nofFollowBits += renorm.underflowBits;
+    m_low = impl::arithShift(m_low, renorm, 0u);
+    uint32_t nofShifts = renorm.leadingBits + renorm.underflowBits;
+    m_high = impl::arithShift(m_high, renorm, (1u << nofShifts) - 1u);
+  }
+
+  //! Function to flush the final bits, must be called after the last symbol
+  void finish();
+
+ private:
+  /*!
+   * Writes the nnofBits (1 to 16) bits in bits, with the pending bits to follow inserted behind
+   * the first one. The bits to follow are the inverse of the first bit.
+   */
+  void writeBits(uint32_t bits, uint32_t nnofBits) {
+    if (m_nofFollowBits + nnofBits > 64u) {
+      writeBitsSlow(bits, nnofBits);
+      return;
+    }
+    uint32_t nofRestBits = nnofBits - 1u;
+    uint64_t firstBit = bits >> nofRestBits;
+    uint64_t followBits = firstBit != 0 ? 0u : (uint64_t{1} << m_nofFollowBits) - 1u;
+    uint64_t sequence = (((firstBit << m_nofFollowBits) | followBits) << nofRestBits) |
+                        (bits & ((1u << nofRestBits) - 1u));
+    m_buffer.write(sequence, static_cast<uint32_t>(m_nofFollowBits) + nnofBits);
+    m_nofFollowBits = 0;
+  }
+  //! Same as writeBits for a large number of bits to follow
+  void writeBitsSlow(uint32_t bits, uint32_t nnofBits);
+  //! Throws the exception for a symbol with a frequency of 0
+  void zeroFrequency();
+
+  //! The buffer to write to
+  BufferT& m_buffer;
+  //! Lower bound of the interval
+  uint32_t m_low;
+  //! Upper bound of the interval
+  uint32_t m_high;
+  //! Number of pending underflow bits, written inverted behind the next emitted bit
+  uint64_t m_nofFollowBits;
+};
+
+extern template class CBasicArithDecoder<CBitParser>;
+extern template class CBasicArithDecoder<CBitParser64>;
+extern template class CBasicArithEncoder<CBitBuffer>;
+extern template class CBasicArithEncoder<CBitBuffer64>;
+
+//! Arithmetic decoder reading from an ilo::CBitParser
+using CArithDecoder = CBasicArithDecoder<CBitParser>;
+//! Arithmetic decoder reading from an ilo::CBitParser64
+using CArithDecoder64 = CBasicArithDecoder<CBitParser64>;
+//! Arithmetic encoder writing to an ilo::CBitBuffer
+using CArithEncoder = CBasicArithEncoder<CBitBuffer>;
+//! Arithmetic encoder writing to an ilo::CBitBuffer64
+using CArithEncoder64 = CBasicArithEncoder<CBitBuffer64>;
+}  // namespace ilo
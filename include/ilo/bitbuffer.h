@@ -88,6 +88,8 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <iostream>
 #include <type_traits>
@@ -96,6 +98,7 @@ amm-info@iis.fraunhofer.de
 #include "ilo/bitparser.h"
 #include "ilo/common_types.h"
 #include "ilo/bittool_utils.h"
+#include "ilo/vlc.h"
 
 namespace ilo {
 /*!
@@ -104,6 +107,11 @@ namespace ilo {
  * This class can operate on an existing external buffer or on an internally managed one and allows
  * features like bit-wise writing, inserting at specific positions and erasing.
  *
+ * Written bits are collected in a 64 bit accumulator and stored to the buffer in whole 32 bit
+ * words. The last up to 31 written bits are only stored by @ref flush and by the functions which
+ * expose or rearrange the buffer (e.g. @ref bufferPtr, @ref bytebuffer, @ref seek, @ref resize) and
+ * on destruction. Flush before accessing an external buffer directly while the bit buffer is alive.
+ *
  * <b>Example</b><br>
  * The following examples consist of two parts: One showing the actual bitbuffer
  * content, the other showing the appropriate code sections. The write
@@ -164,10 +172,32 @@ namespace ilo {
  * #9c9c1a;">0</TD> <TD style="background-color: #9c9c1a;">0</TD><TD>1</TD></TR>
  * </TABLE><br>
  *
+ * @tparam PosT Type of bit positions and sizes. Use the aliases ilo::CBitBuffer (32 bit, up to
+ * 512 MiB) and ilo::CBitBuffer64 (64 bit, for very large buffers).
+ * @tparam BitOrderT Bit order policy, ilo::SMsbFirst (default) or ilo::SLsbFirst (see
+ * ilo::CBitBufferLsb).
+ *
  * \ingroup bittools
  */
-class CBitBuffer {
+template <typename PosT, typename BitOrderT = SMsbFirst>
+class CBasicBitBuffer {
+  static_assert(std::is_same<PosT, uint32_t>::value || std::is_same<PosT, uint64_t>::value,
+                "Bit positions must be either uint32_t or uint64_t");
+
  public:
+  //! Unsigned type of bit positions and sizes
+  using PosType = PosT;
+  //! Signed type of relative bit positions
+  using OffsetType = typename std::make_signed<PosT>::type;
+
+  //! Handle of a field reserved by @ref reserveField, to be filled in later by @ref patch
+  struct SReservedField {
+    //! Bit position of the field
+    PosT position;
+    //! Width of the field in bits (0 if the reservation failed)
+    uint32_t nofBits;
+  };
+
   /*!
    * @brief Create writer with an internally managed buffer
    *
@@ -179,7 +209,7 @@ class CBitBuffer {
    * @note Growing the buffer might be slow so the initLengthInBytes should be chosen wisely for
    * big data chunks.
    */
-  explicit CBitBuffer(uint32_t initLengthInBytes = 0);
+  explicit CBasicBitBuffer(PosT initLengthInBytes = 0);
 
   /*!
    * @brief Create writer from an externally managed buffer
@@ -191,7 +221,7 @@ class CBitBuffer {
    * Used to specify byte-aligned buffers with overhead at the end of the buffer. If 0, the whole
    * buffer is considered to contain valid data.
    */
-  CBitBuffer(ilo::ByteBuffer& externalBuffer, uint32_t nofValidBits = 0);
+  CBasicBitBuffer(ilo::ByteBuffer& externalBuffer, PosT nofValidBits = 0);
 
   /*!
    * @brief Create writer from a data pointer
@@ -204,7 +234,7 @@ class CBitBuffer {
    * Used to specify byte-aligned buffers with overhead at the end of the buffer. If 0, the whole
    * buffer is considered to contain valid data.
    */
-  CBitBuffer(uint8_t* buffer, size_t sizeBytes, uint32_t nofValidBits = 0);
+  CBasicBitBuffer(uint8_t* buffer, size_t sizeBytes, PosT nofValidBits = 0);
 
   /*!
    * @brief Copy constructor (not allowed for external buffer)
@@ -212,14 +242,14 @@ class CBitBuffer {
    * Needed for all assignments and call by value. The copy constructor is often called implicitly
    * and may degrade performance. Try to avoid call by value, if not necessary.
    */
-  CBitBuffer(const CBitBuffer& copyBuffer);
+  CBasicBitBuffer(const CBasicBitBuffer& copyBuffer);
 
   /*!
    * @brief Frees all self allocated memory
    *
-   * This does not alter the external buffer.
+   * Stores the pending bits to the external buffer, but does not alter it otherwise.
    */
-  ~CBitBuffer();
+  ~CBasicBitBuffer();
 
   /*!
    * @brief Function to write a boolean value into the bit buffer
@@ -245,111 +275,264 @@ class CBitBuffer {
     static_assert(
         std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value,
         "Can only write unsigned integer types");
-    if (m_useExtBuffer) {
-      iloAssertWithWriteException(
-          m_extBufferSizeBytes * 8u >= tell() + nnofBits,
-          "Number of bits to write is exceeding the available size of the buffer.");
-    }
-
     size_t size = sizeof(T) * 8u;
+    if ((m_useExtBuffer && m_extBufferSizeBytes * 8u < tell() + nnofBits) || nnofBits > size) {
+      writeFailed(nnofBits, static_cast<PosT>(size));
+      return;
+    }
 
-    iloAssertWithWriteException(
-        size >= nnofBits,
-        "Number of bits to write is larger than the size of the value which is written.");
-
-    // the bits, which are in the first 8bit-field - all remaining can be added with 8 bit and
-    // shift...
-    uint32_t nonAlignedBits = nnofBits & 0x07u;
-    uint8_t writer =
-        nnofBits == size ? 0u : static_cast<uint8_t>(toWrite >> (nnofBits - nonAlignedBits));
-
-    // write the first non aligned bits:
-    writeIntern(writer, nonAlignedBits);
-
-    // now we need a bit counter to decrease the number of bits to be written
-    uint32_t bitCounter = nnofBits - nonAlignedBits;
-    while (bitCounter >= 8u) {
-      bitCounter -= 8u;
-      writer = static_cast<uint8_t>(0xFFu & (toWrite >> bitCounter));
-      writeIntern(writer, 8u);
+    if (nnofBits != 0) {
+      writeIntern(static_cast<uint64_t>(toWrite), nnofBits);
     }
   }
 
   /*!
-   * @brief Append another byte buffer at the current write position.
+   * @brief Function to write a field with a width known at compile time
    *
-   * Function to append another byte buffer to the existing buffer at the current write position.
-   * Overwrites the data following the current write position.
+   * Same as @ref write(T, uint32_t), but the width is checked against T at compile time and the
+   * write is specialized for NofBits.
    *
-   * @param toAppend Byte buffer to append
+   * @code
+   * // Write the value 5 as 12 bit field
+   * bitbuffer.write<12>(uint16_t{5});
+   * @endcode
    */
-  void append(const ilo::ByteBuffer& toAppend);
+  template <uint32_t NofBits, typename T>
+  void write(T toWrite) {
+    static_assert(
+        std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value,
+        "Can only write unsigned integer types");
+    static_assert(NofBits <= sizeof(T) * 8u,
+                  "Number of bits to write is larger than the size of the value which is written.");
+    if (m_useExtBuffer && m_extBufferSizeBytes * 8u < tell() + NofBits) {
+      writeFailed(NofBits, NofBits);
+      return;
+    }
+    if (NofBits != 0) {
+      writeIntern(static_cast<uint64_t>(toWrite), NofBits);
+    }
+  }
 
   /*!
-   * @brief Function to insert a certain number of bits at a specific location
+   * @brief Function to write an array of equally sized fields
    *
-   * @param toInsert Data to be written
-   * @param before Integer position of the bit right behind the insertion point
-   * @param nnofBits Number of bits to insert
+   * Same as calling @ref write(T, uint32_t) count times, but the capacity is checked once for all
+   * fields.
+   *
+   * @param values The values to write
+   * @param count Number of values
+   * @param nnofBits Width of each field
    */
   template <typename T>
-  void insert(T toInsert, uint32_t before, uint32_t nnofBits) {
+  void writeArray(const T* values, size_t count, uint32_t nnofBits) {
     static_assert(
         std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value,
-        "Can only insert unsigned integer types");
-    // basic error handling
-    iloAssertWithInsertException(before <= nofBits(), "Insert position is out of range.");
-
-    if (m_useExtBuffer) {
-      iloAssertWithInsertException(m_extBufferSizeBytes * 8u >= nofBits() + nnofBits,
-                                   "External buffer too small to insert.");
+        "Can only write unsigned integer types");
+    if (nnofBits > sizeof(T) * 8u) {
+      writeFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u));
+      return;
+    }
+    if (nnofBits == 0 || count == 0) {
+      return;
+    }
+    if (count > (std::numeric_limits<PosT>::max() - tell()) / nnofBits) {
+      writeError(EBitError::invalidNofBits, "Array exceeds the addressable bit range.");
+      return;
+    }
+    PosT nofBitsTotal = static_cast<PosT>(count) * nnofBits;
+    if (!canWrite(nofBitsTotal)) {
+      return;
+    }
+    if (nnofBits > 32u) {
+      for (size_t i = 0; i < count; ++i) {
+        writeIntern(static_cast<uint64_t>(values[i]), nnofBits);
+      }
+      return;
     }
 
-    uint32_t writePosBefore = tell();
-    uint32_t toReadBits = nofBits() - before;
+    reserveBits(nofBitsTotal);
+    uint64_t mask = (uint64_t{1} << nnofBits) - 1u;
+    for (size_t i = 0; i < count; ++i) {
+      accumulate(static_cast<uint64_t>(values[i]) & mask, nnofBits);
+    }
+  }
 
-    CBitParser parser(&m_buffer[before >> 3u], toReadBits + before % 8u);
-    parser.seek(before % 8u, EPosType::begin);
+  /*!
+   * @brief Function to write an MPEG-H escapedValue()
+   *
+   * Counterpart of CBasicBitParser::readEscapedValue. Writes value into a nBits1 field, escaping
+   * to a nBits2 and a nBits3 field if it does not fit (see ISO/IEC 23008-3, escapedValue()).
+   *
+   * @param value Value to write
+   * @param nBits1 Width of the first field (max. 32)
+   * @param nBits2 Width of the second field (max. 32)
+   * @param nBits3 Width of the third field (max. 32)
+   */
+  void writeEscapedValue(uint64_t value, uint32_t nBits1, uint32_t nBits2, uint32_t nBits3);
 
-    // extract all bits after specified position:
-    CBitBuffer tmpBuffer;
-    uint8_t reader;
+  /*!
+   * @brief Function to write an unsigned integer as Exp-Golomb code of order k
+   *
+   * Counterpart of CBasicBitParser::readExpGolomb. The whole codeword is written in one step.
+   *
+   * @note Values which need more than 31 - k leading zeros are rejected with
+   * ilo::EBitError::invalidCode.
+   */
+  void writeExpGolomb(uint32_t value, uint32_t k = 0);
 
-    while (toReadBits > 0) {
-      uint32_t chunkSizeBits = std::min(8u, toReadBits);
-      reader = parser.read<uint8_t>(chunkSizeBits);
+  //! Function to write a signed integer as Exp-Golomb code (se(v))
+  void writeSignedExpGolomb(int32_t value);
 
-      tmpBuffer.write<uint8_t>(reader, chunkSizeBits);
+  /*!
+   * @brief Function to write a unary coded value
+   *
+   * Counterpart of CBasicBitParser::readUnary. Writes value 1 bits followed by a 0 bit.
+   */
+  void writeUnary(uint32_t value);
 
-      toReadBits -= chunkSizeBits;
+  /*!
+   * @brief Function to write a value as variable length codeword
+   *
+   * Counterpart of CBasicBitParser::readVlc. The codeword is looked up in the encoding table of the
+   * given ilo::CVlcTable and written in one step.
+   *
+   * @note Values which are not part of the codebook are rejected with ilo::EBitError::invalidCode.
+   */
+  void writeVlc(const CVlcTable& table, int32_t value) {
+    const SVlcCode* code = table.find(value);
+    if (code == nullptr) {
+      writeError(EBitError::invalidCode, "Value is not part of the VLC codebook.");
+      return;
     }
+    if (canWrite(code->nofBits)) {
+      writeIntern(BitOrderT::sequenceBits(code->code, code->nofBits), code->nofBits);
+    }
+  }
 
-    // resize the buffer to truncate the data behind position
-    resize(before);
+  /*!
+   * @brief Function to reserve a field which is filled in later
+   *
+   * Writes nnofBits zero bits at the current write position like @ref write(T, uint32_t) and
+   * returns a handle to them. Used for lengths and counts which are only known after the
+   * following data is written, without shifting that data with @ref insert.
+   *
+   * @code
+   * auto sizeField = bitbuffer.reserveField(32);
+   * PosType start = bitbuffer.tell();
+   * writePayload(bitbuffer);
+   * bitbuffer.patch(sizeField, (bitbuffer.tell() - start) / 8u);
+   * @endcode
+   *
+   * @param nnofBits Width of the field (max. 64)
+   * @return Handle of the field. It stays valid as the buffer grows, but not if bits in front of
+   * the field are inserted or erased.
+   */
+  SReservedField reserveField(uint32_t nnofBits);
 
-    // add the new data at end:
-    seek(0, ilo::EPosType::end);
+  /*!
+   * @brief Function to fill in a field reserved by @ref reserveField
+   *
+   * Overwrites the bits of the field with value. The write position is not changed.
+   *
+   * @param field Handle of the field
+   * @param value Value of the field, values which do not fit into the field are rejected with
+   * ilo::EBitError::invalidNofBits
+   */
+  void patch(const SReservedField& field, uint64_t value);
 
-    // write the bits to insert
-    write<T>(toInsert, nnofBits);
+  /*!
+   * @brief Append another byte buffer behind the last bit of the buffer.
+   *
+   * Function to append another byte buffer to the end of the existing buffer. The write position is
+   * kept, unless it is at the end of the buffer, then it is moved behind the appended data.
+   *
+   * @param toAppend Byte buffer to append
+   */
+  void append(const ilo::ByteBuffer& toAppend);
 
-    CBitParser tmpParser(tmpBuffer.bufferPtr(), tmpBuffer.nofBits());
+  /*!
+   * @brief Append a range of bits behind the last bit of the buffer
+   *
+   * Same as @ref append(const ilo::ByteBuffer&), but for an arbitrary bit range of a byte array
+   * in the bit order of this buffer, e.g. of CBasicBitParser::internalBufferPtr or the @ref
+   * bufferPtr of another bit buffer. The bits are copied in whole bytes if source and destination
+   * are byte aligned and in shifted 64 bit words otherwise.
+   *
+   * @param src The byte array holding the bits
+   * @param srcBitOffset Position of the first bit to append in src
+   * @param nBits Number of bits to append
+   */
+  void appendBits(const uint8_t* src, size_t srcBitOffset, size_t nBits);
 
-    // append the extracted old data:
-    uint32_t writtenBits = tmpBuffer.nofBits();
-    while (writtenBits > 0) {
-      uint32_t chunkSizeBits = std::min(8u, writtenBits);
-      reader = tmpParser.read<uint8_t>(chunkSizeBits);
+  /*!
+   * @brief Append the next bits of a bit parser behind the last bit of the buffer
+   *
+   * The bits are consumed. Byte aligned bytes are appended in place, unaligned ones are copied
+   * with CBasicBitParser::bytesView first.
+   *
+   * @param parser Parser positioned at the first bit of the range
+   * @param nnofBits Number of bits to append
+   *
+   * @note If the parser has not enough bits left, it reports the error according to its error
+   * mode and nothing is appended.
+   */
+  template <typename ParserPosT>
+  void appendBits(CBasicBitParser<ParserPosT, BitOrderT>& parser, ParserPosT nnofBits) {
+    ByteBuffer scratch;
+    if (nnofBits > parser.nofBitsLeft()) {
+      // let the parser report the missing bits
+      parser.bytesView(static_cast<size_t>((nnofBits + 7u) / 8u), scratch);
+      return;
+    }
+    SBytesView view = parser.bytesView(static_cast<size_t>(nnofBits / 8u), scratch);
+    appendBits(view.data, 0u, view.size * 8u);
+    uint32_t nofTailBits = static_cast<uint32_t>(nnofBits % 8u);
+    if (nofTailBits != 0) {
+      uint8_t tail = parser.template read<uint8_t>(nofTailBits);
+      tail = static_cast<uint8_t>(BitOrderT::kMsbFirst ? tail << (8u - nofTailBits) : tail);
+      appendBits(&tail, 0u, nofTailBits);
+    }
+  }
+
+  /*!
+   * @brief Function to insert a certain number of bits at a specific location
+   *
+   * @param toInsert Data to be written
+   * @param before Integer position of the bit right behind the insertion point
+   * @param nnofBits Number of bits to insert
+   */
+  template <typename T>
+  void insert(T toInsert, PosT before, uint32_t nnofBits) {
+    static_assert(
+        std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value,
+        "Can only insert unsigned integer types");
+    // basic error handling
+    if (before > nofBits()) {
+      insertFailed(EBitError::invalidPosition, "Insert position is out of range.");
+      return;
+    }
 
-      write(reader, chunkSizeBits);
+    if (m_useExtBuffer && m_extBufferSizeBytes * 8u < nofBits() + nnofBits) {
+      insertFailed(EBitError::bufferTooSmall, "External buffer too small to insert.");
+      return;
+    }
 
-      writtenBits -= chunkSizeBits;
+    if (nnofBits > sizeof(T) * 8u) {
+      writeFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u));
+      return;
     }
 
+    PosT writePosBefore = tell();
+
+    // move the bits behind the insertion point and write the new bits into the gap
+    openGap(before, nnofBits);
+    seek(static_cast<OffsetType>(before), ilo::EPosType::begin);
+    write<T>(toInsert, nnofBits);
+
     if (writePosBefore < before) {
-      seek(static_cast<int32_t>(writePosBefore), ilo::EPosType::begin);
-    } else if (writePosBefore >= before) {
-      seek(static_cast<int32_t>(writePosBefore + nnofBits), ilo::EPosType::begin);
+      seek(static_cast<OffsetType>(writePosBefore), ilo::EPosType::begin);
+    } else {
+      seek(static_cast<OffsetType>(writePosBefore + nnofBits), ilo::EPosType::begin);
     }
   }
 
@@ -362,7 +545,7 @@ class CBitBuffer {
    * @param firstBit Position of first bit to be erased
    * @param nnofBits Number of bits to be erased
    */
-  void erase(uint32_t firstBit, uint32_t nnofBits);
+  void erase(PosT firstBit, PosT nnofBits);
 
   /*!
    * @brief Function to resize the bitbuffer to the specified length in bits
@@ -372,7 +555,7 @@ class CBitBuffer {
    * @param newSizeInBits New size for the bitbuffer, everything behind the newSize bit will be
    * truncated. If the new size is larger than previous one, the appended bits will be zero
    */
-  void resize(uint32_t newSizeInBits);
+  void resize(PosT newSizeInBits);
 
   /*!
    * @brief Function to seek to a specified bit position
@@ -386,23 +569,24 @@ class CBitBuffer {
    * @note When using ilo::EPosType::end or ilo::EPosType::cur, bitposition can also be a negative
    * value to indicate a backward seeking operation.
    */
-  void seek(int32_t bitposition, ilo::EPosType fromPosition) const;
+  void seek(OffsetType bitposition, ilo::EPosType fromPosition) const;
 
   /*!
    * @brief Function to get the writer's bitposition
    *
    * @return The current writers bit position from the beginning of the buffer.
    */
-  uint32_t tell() const;
+  PosT tell() const;
 
   /*!
    * @brief Function to reserve some data in the internal buffer without setting the buffers size -
    * only its capacity
    *
-   * If newCapacity is bigger than the current max capacity, the capacity of the buffer will be
-   * increased. This will not alter the current fill state of the buffer.
+   * If newCapacity (in bytes) is bigger than the current max capacity, the capacity of the buffer
+   * will be increased. This will not alter the current fill state of the buffer. Without reserve,
+   * the capacity grows geometrically.
    */
-  void reserve(uint32_t newCapacity);
+  void reserve(PosT newCapacity);
 
   /*!
    * @brief Function to align write pointer to byte border
@@ -417,18 +601,29 @@ class CBitBuffer {
    *
    * @return Size in bytes of bitbuffer
    */
-  uint32_t nofBytes() const;
+  PosT nofBytes() const;
 
   /*!
    * @brief Function to get access to internal buffer
    *
+   * Stores the pending bits first.
+   *
    * @return Pointer to internal byte buffer
    */
   uint8_t* bufferPtr();
 
+  /*!
+   * @brief Function to store the pending bits of the accumulator to the buffer
+   *
+   * Only needed to access an external buffer directly while the bit buffer is in use.
+   */
+  void flush();
+
   /*!
    * @brief Function to get a copy of the internal buffer
    *
+   * Stores the pending bits first.
+   *
    * @return Copy of internal byte buffer
    */
   ilo::ByteBuffer bytebuffer() const;
@@ -440,13 +635,137 @@ class CBitBuffer {
    * Including initially added bits and bits inserted at the end. The nofBytes
    * value is not necessarily the same as nofBits()/8 in case of unaligned buffers.
    */
-  uint32_t nofBits() const;
+  PosT nofBits() const;
+
+  /*!
+   * @brief Function to select how failed operations are reported
+   *
+   * @param mode ilo::EErrorMode::exception (default) throws the exception matching the operation,
+   * ilo::EErrorMode::latch only sets the sticky error code. In latching mode failed operations are
+   * dropped and leave buffer content and write position unchanged.
+   */
+  void setErrorMode(EErrorMode mode);
+
+  //! Function to get the current error handling mode
+  EErrorMode errorMode() const;
+
+  /*!
+   * @brief Function to get the sticky error code
+   *
+   * @return The first error that occurred since construction or the last call of @ref clearError.
+   * Always ilo::EBitError::none in ilo::EErrorMode::exception.
+   */
+  EBitError error() const { return m_error; }
+
+  //! Function to check whether an error was latched
+  bool hasError() const { return m_error != EBitError::none; }
+
+  //! Function to reset the sticky error code
+  void clearError();
 
  private:
-  void writeIntern(uint8_t toWrite, uint32_t nnofBits);
+  //! Maximum number of bits added to the accumulator at once
+  static const uint32_t kMaxAccumulateBits = 32u;
 
-  void iloAssertWithWriteException(bool cond, std::string msg);
-  void iloAssertWithInsertException(bool cond, std::string msg);
+  /*!
+   * Writes the nnofBits (1 to 64) least significant bits of toWrite at the write position. All
+   * checks must have been done before.
+   */
+  void writeIntern(uint64_t toWrite, uint32_t nnofBits) {
+    if (nnofBits > kMaxAccumulateBits) {
+      // split into two fields in stream order
+      if (BitOrderT::kMsbFirst) {
+        writeIntern(toWrite >> 32u, nnofBits - 32u);
+      } else {
+        writeIntern(toWrite, nnofBits - 32u);
+        toWrite >>= nnofBits - 32u;
+      }
+      nnofBits = 32u;
+    }
+    reserveBits(nnofBits);
+    accumulate(toWrite & (~uint64_t{0} >> (64u - nnofBits)), nnofBits);
+  }
+
+  //! Makes room for nnofBits bits behind the write position and counts them as valid
+  void reserveBits(PosT nnofBits) {
+    PosT endBits = m_writeIterBytes * 8u + m_localWriteBits + nnofBits;
+    if (endBits > m_nofvalidBits) {
+      if (!m_useExtBuffer && m_internalBuffer.size() * 8u < endBits) {
+        growTo(endBits);
+      }
+      m_nofvalidBits = endBits;
+    }
+  }
+
+  //! Appends nnofBits (1 to 32) bits to the accumulator, stores a word once 32 bits are pending
+  void accumulate(uint64_t bits, uint32_t nnofBits) {
+    if (BitOrderT::kMsbFirst) {
+      m_acc = (m_acc << nnofBits) | bits;
+    } else {
+      m_acc |= bits << m_localWriteBits;
+    }
+    m_localWriteBits += nnofBits;
+    if (m_localWriteBits >= 32u) {
+      storeAccumulatorWord();
+    }
+  }
+
+  //! Stores the first 32 pending bits to the buffer
+  void storeAccumulatorWord() {
+    m_localWriteBits -= 32u;
+    uint32_t word;
+    if (BitOrderT::kMsbFirst) {
+      word = static_cast<uint32_t>(m_acc >> m_localWriteBits);
+    } else {
+      word = static_cast<uint32_t>(m_acc);
+      m_acc >>= 32u;
+    }
+    uint8_t* dst = m_buffer + m_writeIterBytes;
+    uint8_t keptMask = BitOrderT::leadingBitsMask(m_accMergeBits);
+    uint8_t kept = static_cast<uint8_t>(dst[0] & keptMask);
+    for (uint32_t i = 0; i < 4u; ++i) {
+      uint32_t shift = BitOrderT::kMsbFirst ? 24u - 8u * i : 8u * i;
+      dst[i] = static_cast<uint8_t>(word >> shift);
+    }
+    dst[0] = static_cast<uint8_t>(kept | (dst[0] & ~keptMask));
+    m_accMergeBits = 0;
+    m_writeIterBytes += 4u;
+  }
+
+  //! Stores all pending bits to the buffer without changing the accumulator
+  void flushAccumulator() const;
+
+  //! Moves the write position to bitPosition without storing the pending bits
+  void resetAccumulator(PosT bitPosition) const {
+    m_writeIterBytes = bitPosition >> 3u;
+    m_localWriteBits = static_cast<uint32_t>(bitPosition & 0x07u);
+    m_accMergeBits = m_localWriteBits;
+    m_acc = 0u;
+  }
+
+  //! Grows the capacity of the internal buffer to hold at least nofBitsNeeded bits
+  void growTo(PosT nofBitsNeeded);
+
+  //! Moves the bits from position to the end nnofBits bits backwards, extending the buffer
+  void openGap(PosT position, PosT nnofBits);
+
+  //! Used size of the internal buffer, the bytes behind it up to its capacity are 0
+  size_t internalSize() const { return std::max<size_t>(m_sizeBytes, nofBytes()); }
+
+  //! Throws or latches the error of a write which failed the capacity or width check
+  void writeFailed(PosT nnofBits, PosT maxNofBits);
+  //! Throws a WriteException or latches the error depending on the error mode
+  void writeError(EBitError error, const char* msg);
+  //! Checks the capacity of an external buffer for writing nnofBits bits
+  bool canWrite(PosT nnofBits) {
+    if (m_useExtBuffer && m_extBufferSizeBytes * 8u < tell() + nnofBits) {
+      writeFailed(nnofBits, nnofBits);
+      return false;
+    }
+    return true;
+  }
+  //! Throws an InsertException or latches the error depending on the error mode
+  void insertFailed(EBitError error, const char* msg);
 
   //! Indicates whether we use an external buffer or not
   bool m_useExtBuffer;
@@ -456,14 +775,37 @@ class CBitBuffer {
   uint8_t* m_buffer;
   //! The size of the external buffer
   size_t m_extBufferSizeBytes;
-  //! The write pointer
-  mutable uint32_t m_writeIterBytes;
-  //! The number of written bits in current byte (max 7)
+  //! The size of the internal buffer set by the constructor or resize, extended by written data
+  PosT m_sizeBytes;
+  //! The byte at which the accumulator starts
+  mutable PosT m_writeIterBytes;
+  //! The number of bits in the accumulator (max. 31 between writes)
   mutable uint32_t m_localWriteBits;
+  //! The bits of the accumulator in stream order, right aligned for ilo::SMsbFirst
+  mutable uint64_t m_acc;
+  //! The number of leading bits of the accumulator which are kept from the buffer (max. 7)
+  mutable uint32_t m_accMergeBits;
   //! Number of valid bits
-  uint32_t m_nofvalidBits;
-
-};  // CBitBuffer
+  PosT m_nofvalidBits;
+  //! Error handling mode
+  EErrorMode m_errorMode;
+  //! Sticky error code in latching mode
+  mutable EBitError m_error;
+};  // CBasicBitBuffer
+
+extern template class CBasicBitBuffer<uint32_t, SMsbFirst>;
+extern template class CBasicBitBuffer<uint64_t, SMsbFirst>;
+extern template class CBasicBitBuffer<uint32_t, SLsbFirst>;
+extern template class CBasicBitBuffer<uint64_t, SLsbFirst>;
+
+//! Bit buffer with 32 bit positions
+using CBitBuffer = CBasicBitBuffer<uint32_t>;
+//! Bit buffer with 64 bit positions
+using CBitBuffer64 = CBasicBitBuffer<uint64_t>;
+//! Bit buffer with 32 bit positions for LSB-first bitstreams
+using CBitBufferLsb = CBasicBitBuffer<uint32_t, SLsbFirst>;
+//! Bit buffer with 64 bit positions for LSB-first bitstreams
+using CBitBuffer64Lsb = CBasicBitBuffer<uint64_t, SLsbFirst>;
 
 std::ostream& operator<<(std::ostream& s, ilo::CBitBuffer bitbuffer);
 
@@ -88,14 +88,135 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <algorithm>
 #include <iostream>
 #include <type_traits>
 
 // Internal includes
 #include "ilo/common_types.h"
 #include "ilo/bittool_utils.h"
+#include "ilo/vlc.h"
 
 namespace ilo {
+namespace impl {
+/*!
+ * @brief Cache register engine of the bit readers
+ *
+ * Keeps the bits following the read position in stream order in a 64 bit register (MSB-aligned
+ * for ilo::SMsbFirst, LSB-aligned for ilo::SLsbFirst). The register is refilled from the read
+ * position with a single unaligned 64 bit load, so at least 57 bits are available after each
+ * refill. There are no bounds checks, but loads never access memory behind nofBytes.
+ */
+template <typename PosT, typename BitOrderT = SMsbFirst>
+struct SBitReadCache {
+  //! Maximum number of bits which can be taken from the cache register after a single refill
+  static const uint32_t kMaxReadBits = 57u;
+
+  //! The buffer that stores the data
+  const uint8_t* buffer;
+  //! Cache register holding the next cacheBits bits of the buffer MSB-aligned
+  uint64_t cache;
+  //! Number of readable bytes behind buffer
+  PosT nofBytes;
+  //! The read position in bits
+  PosT pos;
+  //! Number of valid bits in the cache register
+  uint32_t cacheBits;
+
+  //! Sets the read position and invalidates the cache register
+  void reset(PosT newPos) {
+    pos = newPos;
+    cache = 0u;
+    cacheBits = 0u;
+  }
+
+  //! Reloads the cache register from the current read position
+  void refill() {
+    PosT bytePos = pos >> 3u;
+    uint64_t word = (bytePos + 8u <= nofBytes) ? BitOrderT::loadWord(buffer + bytePos)
+                                               : BitOrderT::loadTail(buffer, nofBytes, bytePos);
+    uint32_t bitOffset = static_cast<uint32_t>(pos & 0x07u);
+    cache = BitOrderT::dropBits(word, bitOffset);
+    cacheBits = 64u - bitOffset;
+  }
+
+  //! Takes 1 to kMaxReadBits bits from the cache register
+  uint64_t read(uint32_t nnofBits) {
+    if (cacheBits < nnofBits) {
+      refill();
+    }
+    uint64_t result = BitOrderT::firstBits(cache, nnofBits);
+    cache = BitOrderT::dropBits(cache, nnofBits);
+    cacheBits -= nnofBits;
+    pos += nnofBits;
+    return result;
+  }
+
+  //! Returns the next 1 to kMaxReadBits bits without consuming them
+  uint64_t peek(uint32_t nnofBits) {
+    if (cacheBits < nnofBits) {
+      refill();
+    }
+    return BitOrderT::firstBits(cache, nnofBits);
+  }
+
+  //! Consumes 0 to kMaxReadBits bits which are already in the cache register
+  void consume(uint32_t nnofBits) {
+    cache = BitOrderT::dropBits(cache, nnofBits);
+    cacheBits -= nnofBits;
+    pos += nnofBits;
+  }
+
+  //! Takes 1 to 64 bits, values wider than kMaxReadBits are read in two parts
+  uint64_t readAny(uint32_t nnofBits) {
+    if (nnofBits <= kMaxReadBits) {
+      return read(nnofBits);
+    }
+    uint64_t first = read(nnofBits - 32u);
+    return BitOrderT::join(first, nnofBits - 32u, read(32u), 32u);
+  }
+};
+
+/*!
+ * @brief Unpacks count consecutive fields of nnofBits (1 to 57) bits starting at bit position pos
+ *
+ * Each field is extracted from its own unaligned 64 bit load, so there is no dependency between
+ * the iterations and the main loop can be unrolled or vectorized by the compiler. Only the fields
+ * close to the end of the buffer take the zero padding load.
+ */
+template <typename BitOrderT, typename T, typename PosT>
+void unpackBits(const uint8_t* buffer, PosT nofBytes, PosT pos, T* out, size_t count,
+                uint32_t nnofBits) {
+  size_t nofWordFields = 0;
+  if (nofBytes >= 8u && pos <= (nofBytes - 8u) * 8u) {
+    PosT lastWordFieldPos = (nofBytes - 8u) * 8u;
+    nofWordFields = std::min<size_t>(
+        count, static_cast<size_t>((lastWordFieldPos - pos) / nnofBits) + 1u);
+  }
+  size_t i = 0;
+  for (; i < nofWordFields; ++i) {
+    PosT fieldPos = pos + static_cast<PosT>(i) * nnofBits;
+    uint64_t word = BitOrderT::loadWord(buffer + (fieldPos >> 3u));
+    word = BitOrderT::dropBits(word, static_cast<uint32_t>(fieldPos & 0x07u));
+    out[i] = castBits<T>(BitOrderT::firstBits(word, nnofBits), nnofBits);
+  }
+  for (; i < count; ++i) {
+    PosT fieldPos = pos + static_cast<PosT>(i) * nnofBits;
+    uint64_t word = BitOrderT::loadTail(buffer, nofBytes, fieldPos >> 3u);
+    word = BitOrderT::dropBits(word, static_cast<uint32_t>(fieldPos & 0x07u));
+    out[i] = castBits<T>(BitOrderT::firstBits(word, nnofBits), nnofBits);
+  }
+}
+}  // namespace impl
+
+//! Read-only view of a range of bytes
+struct SBytesView {
+  //! First byte of the range
+  const uint8_t* data;
+  //! Number of bytes in the range
+  size_t size;
+};
+
 /*!
  * @brief Class for parsing a byte buffer bit-wise
  *
@@ -155,10 +276,24 @@ namespace ilo {
  * the result.
  * @note Ensure to use primitives matching the expected signedness of the value that is read.
  *
+ * @tparam PosT Type of bit positions and sizes. Use the aliases ilo::CBitParser (32 bit, up to
+ * 512 MiB) and ilo::CBitParser64 (64 bit, for very large buffers or memory mapped files).
+ * @tparam BitOrderT Bit order policy, ilo::SMsbFirst (default) or ilo::SLsbFirst (see
+ * ilo::CBitParserLsb).
+ *
  * \ingroup bittools
  */
-class CBitParser {
+template <typename PosT, typename BitOrderT = SMsbFirst>
+class CBasicBitParser {
+  static_assert(std::is_same<PosT, uint32_t>::value || std::is_same<PosT, uint64_t>::value,
+                "Bit positions must be either uint32_t or uint64_t");
+
  public:
+  //! Unsigned type of bit positions and sizes
+  using PosType = PosT;
+  //! Signed type of relative bit positions
+  using OffsetType = typename std::make_signed<PosT>::type;
+
   /*!
    * @brief Create parser from a byte buffer
    *
@@ -169,7 +304,7 @@ class CBitParser {
    * buffers with overhead at the end of the buffer. If 0, the whole buffer is considered to contain
    * valid data.
    */
-  CBitParser(const ByteBuffer& externalBuffer, uint32_t nofValidBits = 0);
+  CBasicBitParser(const ByteBuffer& externalBuffer, PosT nofValidBits = 0);
 
   /*!
    * @brief Create parser from begin iterator and buffer length
@@ -182,7 +317,7 @@ class CBitParser {
    * buffers with overhead at the end of the buffer. If 0, the whole buffer is considered to contain
    * valid data.
    */
-  CBitParser(ByteBuffer::const_iterator& begin, size_t size, uint32_t nofValidBits = 0);
+  CBasicBitParser(ByteBuffer::const_iterator& begin, size_t size, PosT nofValidBits = 0);
 
   /*!
    * @brief Create parser from begin and end iterator
@@ -195,8 +330,8 @@ class CBitParser {
    * buffers with overhead at the end of the buffer. If 0, the whole buffer is considered to contain
    * valid data.
    */
-  CBitParser(ByteBuffer::const_iterator& begin, const ByteBuffer::const_iterator& end,
-             uint32_t nofValidBits = 0);
+  CBasicBitParser(ByteBuffer::const_iterator& begin, const ByteBuffer::const_iterator& end,
+                  PosT nofValidBits = 0);
 
   /*!
    * @brief Create parser from a data pointer
@@ -210,20 +345,20 @@ class CBitParser {
    * @note nofValidBits shall never be 0 or bigger than the amount of bits available behind the data
    * pointer.
    */
-  CBitParser(uint8_t* buffer, uint32_t nofValidBits);
+  CBasicBitParser(uint8_t* buffer, PosT nofValidBits);
 
   /*!
    * @brief Frees all self allocated memory
    *
    * Will not alter any external buffers.
    */
-  ~CBitParser();
+  ~CBasicBitParser();
 
   //! Disallow copy constructor
-  CBitParser(const CBitParser& copyBuffer) = delete;
+  CBasicBitParser(const CBasicBitParser& copyBuffer) = delete;
 
   //! Disallow assignment operator
-  CBitParser& operator=(const CBitParser& copyBuffer) = delete;
+  CBasicBitParser& operator=(const CBasicBitParser& copyBuffer) = delete;
 
   /*!
    * @brief Function to read data from the buffer
@@ -248,20 +383,589 @@ class CBitParser {
   template <typename T>
   T read(uint32_t nnofBits) {
     static_assert(std::is_integral<T>::value, "Can only read integer types");
-    iloAssertWithReadException(nnofBits <= nofBitsLeft(), "Not enough data left to parse.");
+    if (nnofBits > m_nofValidBits - m_state.pos || nnofBits > sizeof(T) * 8u) {
+      return static_cast<T>(readFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u)));
+    }
 
     if (nnofBits == 0) {
       return static_cast<T>(0);
     }
+    return impl::castBits<T>(m_state.readAny(nnofBits), nnofBits);
+  }
+
+  /*!
+   * @brief Function to read a field with a width known at compile time
+   *
+   * Same as @ref read(uint32_t), but the width is checked against T at compile time and the read
+   * is specialized for NofBits.
+   *
+   * @code
+   * // Read a 12 bit field as 16 bit unsigned integer
+   * uint16_t data = parser.read<uint16_t, 12>();
+   * @endcode
+   */
+  template <typename T, uint32_t NofBits>
+  T read() {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    static_assert(NofBits <= sizeof(T) * 8u, "Number of bits does not fit into the given variable");
+    if (NofBits > m_nofValidBits - m_state.pos) {
+      return static_cast<T>(readFailed(NofBits, NofBits));
+    }
+    if (NofBits == 0) {
+      return static_cast<T>(0);
+    }
+    return impl::castBits<T>(m_state.readAny(NofBits), NofBits);
+  }
+
+  /*!
+   * @brief Function to read data without any error reporting
+   *
+   * Same as @ref read, but a failed read neither throws nor latches an error. Meant for
+   * speculative parsing, e.g. when hunting for sync words in corrupted streams.
+   *
+   * @param value Receives the read value, unchanged on failure
+   * @param nnofBits The number of bits to read
+   * @return False if not enough data is left or nnofBits does not fit into T. Nothing is consumed
+   * in that case.
+   */
+  template <typename T>
+  bool tryRead(T& value, uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > m_nofValidBits - m_state.pos || nnofBits > sizeof(T) * 8u) {
+      return false;
+    }
+    value = nnofBits == 0 ? static_cast<T>(0)
+                          : impl::castBits<T>(m_state.readAny(nnofBits), nnofBits);
+    return true;
+  }
+
+  /*!
+   * @brief Function to read data without advancing the read position
+   *
+   * Same as @ref read, but the bits are taken from the cache register without consuming them, so
+   * they are returned again by the next read. Up to 57 bits are peeked without reloading the cache
+   * register in most cases.
+   */
+  template <typename T>
+  T peek(uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > m_nofValidBits - m_state.pos || nnofBits > sizeof(T) * 8u) {
+      return static_cast<T>(readFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u)));
+    }
+    if (nnofBits == 0) {
+      return static_cast<T>(0);
+    }
+    if (nnofBits <= impl::SBitReadCache<PosT, BitOrderT>::kMaxReadBits) {
+      return impl::castBits<T>(m_state.peek(nnofBits), nnofBits);
+    }
+    impl::SBitReadCache<PosT, BitOrderT> state = m_state;
+    return impl::castBits<T>(state.readAny(nnofBits), nnofBits);
+  }
 
-    bool isSigned = std::is_signed<T>::value;
-    if (isSigned) {
-      return signed_read<T>(nnofBits);
+  /*!
+   * @brief Function to advance the read position
+   *
+   * Skips within the cache register if possible, otherwise the position is set directly. In
+   * contrast to @ref seek there is no relative position computation.
+   *
+   * @param nofBits Number of bits to skip
+   *
+   * @note On failure the read position is not changed.
+   */
+  void skip(PosT nofBits) {
+    if (nofBits > m_nofValidBits - m_state.pos) {
+      readFailed(nofBits, nofBits);
+      return;
+    }
+    if (nofBits < m_state.cacheBits) {
+      m_state.consume(static_cast<uint32_t>(nofBits));
     } else {
-      return unsigned_read<T>(nnofBits);
+      m_state.reset(m_state.pos + nofBits);
+    }
+  }
+
+  /*!
+   * @brief Function to advance the read position by whole bytes
+   *
+   * Same as @ref skip for nofBytes * 8 bits, e.g. to step over unknown extension payloads. The
+   * read position does not need to be byte aligned.
+   */
+  void skipBytes(PosT nofBytes) {
+    if (nofBytes > (m_nofValidBits - m_state.pos) / 8u) {
+      readError(EBitError::endOfData, "Not enough data left to parse.");
+      return;
+    }
+    skip(nofBytes * 8u);
+  }
+
+  /*!
+   * @brief Function to search a bit pattern at bit granularity
+   *
+   * Finds the next position at which @ref read would return pattern, e.g. to resynchronize on a
+   * sync word after a damaged part of the stream. The search does not change the read position.
+   * Patterns of 15 bits or more contain a whole byte at every offset, so the data is scanned
+   * bytewise for the 8 possible values of that byte and only candidates are compared. Shorter
+   * patterns are compared at all 8 offsets of each byte against a single 64 bit load.
+   *
+   * @param pattern The pattern to search (the nnofBits least significant bits)
+   * @param nnofBits Width of the pattern (1 to 57)
+   * @param fromBit Position to start the search at (see @ref tell)
+   * @return Position of the first match at or behind fromBit, or @ref nofBits if there is none
+   *
+   * @note An invalid pattern width is reported as ilo::EBitError::invalidNofBits.
+   *
+   * @code
+   * PosType syncPos = parser.findPattern(0xC001A5, 24, parser.tell());
+   * if (syncPos != parser.nofBits()) {
+   *   parser.seek(syncPos, ilo::EPosType::begin);
+   * }
+   * @endcode
+   */
+  PosT findPattern(uint64_t pattern, uint32_t nnofBits, PosT fromBit);
+
+  /*!
+   * @brief Function to read an array of equally sized fields
+   *
+   * Same as calling @ref read count times, but the bounds are checked once and the fields are
+   * unpacked with independent 64 bit loads instead of going through the cache register.
+   *
+   * @param out Destination for count values
+   * @param count Number of fields to read
+   * @param nnofBits Width of each field
+   *
+   * @note On failure out is filled with zeros and nothing is consumed.
+   */
+  template <typename T>
+  void readArray(T* out, size_t count, uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    PosT nofBitsAvailable = m_nofValidBits - m_state.pos;
+    if (nnofBits > sizeof(T) * 8u) {
+      std::fill(out, out + count, static_cast<T>(0));
+      readFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u));
+      return;
+    }
+    if (nnofBits != 0 && count > nofBitsAvailable / nnofBits) {
+      std::fill(out, out + count, static_cast<T>(0));
+      readError(EBitError::endOfData, "Not enough data left to parse.");
+      return;
+    }
+    if (nnofBits == 0) {
+      std::fill(out, out + count, static_cast<T>(0));
+      return;
     }
+    if (nnofBits > impl::SBitReadCache<PosT, BitOrderT>::kMaxReadBits) {
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = impl::castBits<T>(m_state.readAny(nnofBits), nnofBits);
+      }
+      return;
+    }
+    impl::unpackBits<BitOrderT>(m_state.buffer, m_state.nofBytes, m_state.pos, out, count,
+                                nnofBits);
+    m_state.reset(m_state.pos + static_cast<PosT>(count) * nnofBits);
   }
 
+  /*!
+   * @brief Function to copy whole bytes from the bitstream
+   *
+   * Same as reading nofBytes 8 bit values, but a byte aligned read position is served with a single
+   * memcpy. Otherwise the bytes are shifted into place 64 bits at a time.
+   *
+   * @param dst Destination for nofBytes bytes
+   * @param nofBytes Number of bytes to read
+   *
+   * @note On failure nothing is copied and nothing is consumed.
+   */
+  void readBytes(uint8_t* dst, size_t nofBytes);
+
+  /*!
+   * @brief Function to access whole bytes from the bitstream without copying them
+   *
+   * If the read position is byte aligned, the returned view points directly into the parsed buffer
+   * and is valid as long as that buffer. Otherwise the bytes are copied into scratch with
+   * @ref readBytes and the view points into scratch.
+   *
+   * @param nofBytes Number of bytes to read
+   * @param scratch Storage used if the read position is not byte aligned
+   * @return View of the read bytes, empty on failure
+   *
+   * @note On failure nothing is consumed.
+   */
+  SBytesView bytesView(size_t nofBytes, ByteBuffer& scratch);
+
+  /*!
+   * @brief Function to read an MPEG-H escapedValue()
+   *
+   * Reads a nBits1 field. If all its bits are set, a nBits2 field is added, and if all bits of that
+   * one are set as well, a nBits3 field is added (see ISO/IEC 23008-3, escapedValue()). If the sum
+   * of the widths is not larger than 57 bits, the value is decoded from a single cache register
+   * access.
+   *
+   * @param nBits1 Width of the first field (max. 32)
+   * @param nBits2 Width of the second field (max. 32)
+   * @param nBits3 Width of the third field (max. 32)
+   * @return The decoded value
+   *
+   * @note On failure nothing is consumed.
+   */
+  uint64_t readEscapedValue(uint32_t nBits1, uint32_t nBits2, uint32_t nBits3) {
+    // invalid field widths are reported by the slow path
+    if (nBits1 > 32u || nBits2 > 32u || nBits3 > 32u) {
+      return readEscapedValueSlow(nBits1, nBits2, nBits3);
+    }
+    uint32_t maxNofBits = nBits1 + nBits2 + nBits3;
+    if (maxNofBits > impl::SBitReadCache<PosT, BitOrderT>::kMaxReadBits || maxNofBits == 0) {
+      return readEscapedValueSlow(nBits1, nBits2, nBits3);
+    }
+
+    uint64_t window = m_state.peek(maxNofBits);
+    uint32_t nofUsedBits = nBits1;
+    uint64_t field = BitOrderT::extractField(window, maxNofBits, 0, nBits1);
+    uint64_t result = field;
+    if (field == lowBitMask(nBits1)) {
+      field = BitOrderT::extractField(window, maxNofBits, nofUsedBits, nBits2);
+      nofUsedBits += nBits2;
+      result += field;
+      if (field == lowBitMask(nBits2)) {
+        result += BitOrderT::extractField(window, maxNofBits, nofUsedBits, nBits3);
+        nofUsedBits += nBits3;
+      }
+    }
+
+    if (nofUsedBits > m_nofValidBits - m_state.pos) {
+      return readFailed(nofUsedBits, nofUsedBits);
+    }
+    m_state.consume(nofUsedBits);
+    return result;
+  }
+
+  /*!
+   * @brief Function to read an Exp-Golomb coded unsigned integer
+   *
+   * Reads an Exp-Golomb code of order k: N leading zeros, followed by N + 1 + k bits. The leading
+   * zeros are counted with a single count-leading-zeros operation on the cache register.
+   *
+   * @param k Order of the code (0 for ue(v) as used in e.g. AVC/HEVC)
+   * @return The decoded value
+   *
+   * @note Codes with more than 31 - k leading zeros are rejected with ilo::EBitError::invalidCode.
+   * On failure nothing is consumed.
+   */
+  uint32_t readExpGolomb(uint32_t k = 0) {
+    if (m_state.cacheBits < 32u) {
+      m_state.refill();
+    }
+    uint32_t leadingZeros = BitOrderT::countLeadingZeros(m_state.cache);
+    PosT nofBitsAvailable = m_nofValidBits - m_state.pos;
+    uint32_t nofCodeBits = leadingZeros + 1u + k;
+    if (leadingZeros + k > 31u || leadingZeros + nofCodeBits > nofBitsAvailable) {
+      return static_cast<uint32_t>(expGolombFailed(leadingZeros, k));
+    }
+    m_state.consume(leadingZeros);
+    uint64_t codeNum = BitOrderT::sequenceBits(m_state.readAny(nofCodeBits), nofCodeBits);
+    return static_cast<uint32_t>(codeNum - (uint64_t{1} << k));
+  }
+
+  /*!
+   * @brief Function to read an Exp-Golomb coded signed integer (se(v))
+   *
+   * The unsigned code numbers 0, 1, 2, 3, 4, ... are mapped to 0, 1, -1, 2, -2, ...
+   */
+  int32_t readSignedExpGolomb() {
+    uint32_t codeNum = readExpGolomb(0);
+    return (codeNum & 1u) != 0 ? static_cast<int32_t>((codeNum >> 1u) + 1u)
+                               : -static_cast<int32_t>(codeNum >> 1u);
+  }
+
+  /*!
+   * @brief Function to read a unary coded value
+   *
+   * Counts the number of consecutive 1 bits up to the terminating 0 bit, which is consumed as
+   * well. Runs of up to 56 bits are decoded with a single count-leading-zeros operation.
+   *
+   * @return The number of 1 bits
+   *
+   * @note On failure (no terminating 0 bit before the end of the data) nothing is consumed.
+   */
+  uint32_t readUnary() {
+    const PosT maxChunkBits = impl::SBitReadCache<PosT, BitOrderT>::kMaxReadBits;
+    PosT startPos = m_state.pos;
+    uint32_t result = 0;
+    while (true) {
+      if (m_state.cacheBits < maxChunkBits) {
+        m_state.refill();
+      }
+      PosT nofBitsAvailable = std::min<PosT>(m_nofValidBits - m_state.pos, maxChunkBits);
+      uint32_t ones = BitOrderT::countLeadingZeros(~m_state.cache);
+      if (ones < nofBitsAvailable) {
+        m_state.consume(ones + 1u);
+        return result + ones;
+      }
+      if (m_nofValidBits - m_state.pos <= maxChunkBits) {
+        m_state.reset(startPos);
+        return static_cast<uint32_t>(readFailed(m_nofValidBits - startPos + 1u, 64u));
+      }
+      m_state.consume(static_cast<uint32_t>(nofBitsAvailable));
+      result += static_cast<uint32_t>(nofBitsAvailable);
+    }
+  }
+
+  /*!
+   * @brief Function to read a variable length coded value
+   *
+   * Resolves the codeword at the read position with one or two lookups in the given table (see
+   * ilo::CVlcTable) instead of reading it bit by bit.
+   *
+   * @param table Lookup table of the code
+   * @return The value represented by the codeword
+   *
+   * @note Bits which do not start with a valid codeword are rejected with
+   * ilo::EBitError::invalidCode. On failure nothing is consumed.
+   */
+  int32_t readVlc(const CVlcTable& table) {
+    if (m_state.cacheBits < table.maxCodeBits()) {
+      m_state.refill();
+    }
+    const impl::SVlcEntry& entry = table.lookup(BitOrderT::msbWindow(m_state.cache));
+    if (entry.nofBits == 0 || entry.nofBits > m_nofValidBits - m_state.pos) {
+      return static_cast<int32_t>(vlcFailed(entry.nofBits, table.maxCodeBits()));
+    }
+    m_state.consume(entry.nofBits);
+    return entry.value;
+  }
+
+  /*!
+   * @brief Cursor for reading a validated range of bits without any checks
+   *
+   * Created by @ref ensure. The cursor works on a copy of the parser's read state, so the compiler
+   * can keep it in registers inside decoding loops. Reads are plain shifts from the cache register.
+   * The parser's read position is updated by @ref commit and when the cursor goes out of scope. The
+   * parser itself must not be used while a cursor is alive.
+   *
+   * @note Reading more bits than reserved is not detected. It never accesses memory outside the
+   * buffer, but the parser position is clamped to the end of the reserved range on commit.
+   */
+  class Unchecked {
+   public:
+    //! Move constructor, the moved-from cursor does not update the parser anymore
+    Unchecked(Unchecked&& other)
+        : m_parser(other.m_parser),
+          m_state(other.m_state),
+          m_origin(other.m_origin),
+          m_end(other.m_end) {
+      other.m_parser = nullptr;
+    }
+
+    //! Updates the parser's read position
+    ~Unchecked() { commit(); }
+
+    //! Disallow copy constructor
+    Unchecked(const Unchecked&) = delete;
+
+    //! Disallow assignment operator
+    Unchecked& operator=(const Unchecked&) = delete;
+
+    /*!
+     * @brief Function to read data without bounds checks
+     *
+     * Same as @ref CBasicBitParser::read, but the caller guarantees that nnofBits fits into T and
+     * into the reserved range.
+     */
+    template <typename T>
+    T read(uint32_t nnofBits) {
+      static_assert(std::is_integral<T>::value, "Can only read integer types");
+      if (nnofBits == 0) {
+        return static_cast<T>(0);
+      }
+      return impl::castBits<T>(m_state.readAny(nnofBits), nnofBits);
+    }
+
+    //! Function to read a field with a width known at compile time without bounds checks
+    template <typename T, uint32_t NofBits>
+    T read() {
+      static_assert(std::is_integral<T>::value, "Can only read integer types");
+      static_assert(NofBits <= sizeof(T) * 8u,
+                    "Number of bits does not fit into the given variable");
+      if (NofBits == 0) {
+        return static_cast<T>(0);
+      }
+      return impl::castBits<T>(m_state.readAny(NofBits), NofBits);
+    }
+
+    //! Function to read data without bounds checks and without advancing the cursor
+    template <typename T>
+    T peek(uint32_t nnofBits) {
+      static_assert(std::is_integral<T>::value, "Can only read integer types");
+      if (nnofBits == 0) {
+        return static_cast<T>(0);
+      }
+      if (nnofBits <= impl::SBitReadCache<PosT, BitOrderT>::kMaxReadBits) {
+        return impl::castBits<T>(m_state.peek(nnofBits), nnofBits);
+      }
+      impl::SBitReadCache<PosT, BitOrderT> state = m_state;
+      return impl::castBits<T>(state.readAny(nnofBits), nnofBits);
+    }
+
+    //! Function to advance the cursor without bounds checks
+    void skip(PosT nofBits) {
+      if (nofBits < m_state.cacheBits) {
+        m_state.consume(static_cast<uint32_t>(nofBits));
+      } else {
+        m_state.reset(m_state.pos + nofBits);
+      }
+    }
+
+    //! Function to get the cursor's current position in bits
+    PosT tell() const { return m_state.pos - m_origin; }
+
+    //! Function to get the number of reserved bits left to read
+    PosT nofBitsLeft() const { return m_end > m_state.pos ? m_end - m_state.pos : 0u; }
+
+    //! Function to write the current read position back to the parser
+    void commit() {
+      if (m_parser != nullptr) {
+        m_parser->m_state = m_state;
+        if (m_state.pos > m_end) {
+          m_parser->m_state.reset(m_end);
+        }
+      }
+    }
+
+   private:
+    friend class CBasicBitParser;
+
+    Unchecked(CBasicBitParser* parser, const impl::SBitReadCache<PosT, BitOrderT>& state,
+              PosT origin, PosT end)
+        : m_parser(parser), m_state(state), m_origin(origin), m_end(end) {}
+
+    //! The parser to update (nullptr if the reservation failed)
+    CBasicBitParser* m_parser;
+    //! Working copy of the parser's read state
+    impl::SBitReadCache<PosT, BitOrderT> m_state;
+    //! Position reported as 0 by tell()
+    PosT m_origin;
+    //! End of the reserved range in bits
+    PosT m_end;
+  };
+
+  /*!
+   * @brief Function to validate a range of bits once for unchecked reading
+   *
+   * Checks that at least nofBits bits are left to read and returns a cursor which reads them
+   * without further checks.
+   *
+   * @param nofBits Number of bits reserved for the cursor
+   * @return Cursor for reading the reserved range
+   *
+   * @note If the check fails in ilo::EErrorMode::latch, the error is latched and the returned
+   * cursor reads only zeros and does not move the parser.
+   *
+   * @code
+   * {
+   *   auto cursor = parser.ensure(3 + 5 + 24);
+   *   uint8_t type = cursor.read<uint8_t>(3);
+   *   uint8_t index = cursor.read<uint8_t>(5);
+   *   uint32_t length = cursor.read<uint32_t>(24);
+   * }  // parser is now positioned behind the 32 bits
+   * @endcode
+   */
+  Unchecked ensure(PosT nofBits) {
+    if (nofBits > m_nofValidBits - m_state.pos) {
+      readFailed(nofBits, nofBits);
+      impl::SBitReadCache<PosT, BitOrderT> emptyState = m_state;
+      emptyState.nofBytes = 0u;
+      emptyState.reset(m_state.pos);
+      return Unchecked(nullptr, emptyState, m_beginPos, m_state.pos);
+    }
+    return Unchecked(this, m_state, m_beginPos, m_state.pos + nofBits);
+  }
+
+  //! Saved parser state, see @ref checkpoint
+  struct Checkpoint {
+    //! Read position
+    PosT pos;
+    //! Error handling mode before the checkpoint
+    EErrorMode errorMode;
+    //! Sticky error code before the checkpoint
+    EBitError error;
+  };
+
+  /*!
+   * @brief Function to start a speculative parse
+   *
+   * Saves the read position, the error mode and the sticky error code, then switches to
+   * ilo::EErrorMode::latch with a cleared error. So failed reads of the speculative parse are
+   * cheap: they only latch an error instead of logging, formatting and throwing. Checkpoints can be
+   * nested.
+   *
+   * @code
+   * auto checkpoint = parser.checkpoint();
+   * parseHeader(parser);
+   * if (parser.hasError()) {
+   *   parser.rollback(checkpoint);  // try another syntax or resynchronize
+   * } else {
+   *   parser.commit(checkpoint);
+   * }
+   * @endcode
+   */
+  Checkpoint checkpoint() {
+    Checkpoint saved = {m_state.pos, m_errorMode, m_error};
+    m_errorMode = EErrorMode::latch;
+    m_error = EBitError::none;
+    return saved;
+  }
+
+  //! Function to return to the read position and error state saved by @ref checkpoint
+  void rollback(const Checkpoint& saved) {
+    m_state.reset(saved.pos);
+    m_errorMode = saved.errorMode;
+    m_error = saved.error;
+  }
+
+  /*!
+   * @brief Function to accept a speculative parse started by @ref checkpoint
+   *
+   * Keeps the read position and restores the error mode. An error latched during the speculative
+   * parse is kept if there was none before. If the checkpoint was taken in
+   * ilo::EErrorMode::exception, such an error is reported by throwing instead.
+   */
+  void commit(const Checkpoint& saved) {
+    EBitError speculativeError = m_error;
+    m_errorMode = saved.errorMode;
+    if (saved.error != EBitError::none) {
+      m_error = saved.error;
+    } else if (speculativeError != EBitError::none && m_errorMode == EErrorMode::exception) {
+      m_error = EBitError::none;
+      readError(speculativeError, "Committed speculative parse failed.");
+    }
+  }
+
+  class SubParser;
+
+  /*!
+   * @brief Function to create a parser for a nested element of known length
+   *
+   * The returned sub parser shares the buffer and is bounded to the next nofBits bits. Its
+   * positions are relative to the element start. When it goes out of scope (or on
+   * SubParser::finish), this parser is moved to the end of the element, no matter how much of the
+   * element was read. So unknown extensions are skipped by simply not reading them.
+   *
+   * @param nofBits Length of the element in bits
+   * @return Parser for the element
+   *
+   * @note This parser must not be used while the sub parser is alive. If the element exceeds the
+   * data in ilo::EErrorMode::latch, the error is latched and the returned sub parser is empty and
+   * does not move this parser.
+   *
+   * @code
+   * uint32_t size = parser.read<uint32_t>(32);
+   * {
+   *   auto element = parser.subParser(size * 8);
+   *   parseElement(element);  // takes an ilo::CBitParser&
+   * }  // parser is now positioned behind the element
+   * @endcode
+   */
+  SubParser subParser(PosT nofBits);
+
   /*!
    * @brief Function to seek to a specified bit position
    *
@@ -275,14 +979,14 @@ class CBitParser {
    * @note When using ilo::EPosType::end or ilo::EPosType::cur, bitposition can also be a negative
    * value to indicate a backward seeking operation.
    */
-  void seek(int32_t bitposition, ilo::EPosType fromPosition);
+  void seek(OffsetType bitposition, ilo::EPosType fromPosition);
 
   /*!
    * @brief Function to get the reader's current position in bits
    *
    * @return The bit position of the read pointer from the beginning of the buffer.
    */
-  uint32_t tell() const;
+  PosT tell() const;
 
   /*!
    * @brief Function to get the total buffer size in bytes
@@ -292,7 +996,7 @@ class CBitParser {
    * @note The result of this function never changes, since it is based on the values given on the
    * constructor.
    */
-  uint32_t nofBytes() const;
+  PosT nofBytes() const;
 
   //! Function to get access to the internal buffer pointer
   const uint8_t* internalBufferPtr();
@@ -306,17 +1010,17 @@ class CBitParser {
    * constructor.
    * @note The resulting value is not guaranteed to be byte aligned.
    */
-  uint32_t nofBits() const;
+  PosT nofBits() const;
 
   /*!
    * @brief Function to get the number of bits read
    *
    * Same as calling @ref tell
    */
-  uint32_t nofReadBits() const;
+  PosT nofReadBits() const;
 
   //! Function to get the number of bits left to read
-  uint32_t nofBitsLeft() const;
+  PosT nofBitsLeft() const;
 
   /*!
    * @brief Function to get end-of-file indication
@@ -325,76 +1029,142 @@ class CBitParser {
    */
   bool eof() const;
 
- private:
-  uint8_t readUint8(uint32_t nofBits);
+  /*!
+   * @brief Function to select how failed operations are reported
+   *
+   * @param mode ilo::EErrorMode::exception (default) throws ReadException/SeekException,
+   * ilo::EErrorMode::latch only sets the sticky error code. In latching mode failed reads return 0
+   * and leave the read position unchanged.
+   */
+  void setErrorMode(EErrorMode mode);
 
-  void iloAssertWithReadException(bool cond, std::string msg);
-  void iloAssertWithSeekException(bool cond, std::string msg);
+  //! Function to get the current error handling mode
+  EErrorMode errorMode() const;
 
-  template <typename T>
-  T unsigned_read(uint32_t nnofBits) {
-    bool isUint8 = std::is_same<T, uint8_t>::value;
-    if (isUint8) {
-      return static_cast<T>(readUint8(nnofBits));
-    }
+  /*!
+   * @brief Function to get the sticky error code
+   *
+   * @return The first error that occurred since construction or the last call of @ref clearError.
+   * Always ilo::EBitError::none in ilo::EErrorMode::exception.
+   */
+  EBitError error() const { return m_error; }
 
-    // Basic error handling
-    uint32_t maxNumBits = static_cast<uint32_t>(sizeof(T) * 8);
-    iloAssertWithReadException(nnofBits <= maxNumBits,
-                               "Number of bits does not fit into the given variable");
+  //! Function to check whether an error was latched
+  bool hasError() const { return m_error != EBitError::none; }
 
-    // The bits which are in the first 8bit-field - all remaining can be added with 8 bit and
-    // shift...
-    uint32_t nonAlignedBits = nnofBits % 8;
-    // Read the first non aligned bits:
-    T result = static_cast<T>(read<uint8_t>(nonAlignedBits));
+  //! Function to reset the sticky error code
+  void clearError();
 
-    // Now we need a bit counter to decrease the number of bits to be written
-    uint32_t bitCounter = nnofBits - nonAlignedBits;
-    while (bitCounter >= 8) {
-      bitCounter -= 8;
-      result = static_cast<T>((result << 8) | read<uint8_t>(8));
-    }
+ private:
+  //! Throws or latches the error of a read which failed the bounds or width check. Returns 0.
+  uint64_t readFailed(PosT nnofBits, PosT maxNofBits);
+  //! Throws a SeekException or latches the error depending on the error mode
+  void seekFailed(EBitError error, const char* msg);
+  //! Throws a ReadException or latches the error depending on the error mode. Returns 0.
+  uint64_t readError(EBitError error, const char* msg);
+  //! Reports a failed Exp-Golomb read with the given number of leading zeros. Returns 0.
+  uint64_t expGolombFailed(uint32_t leadingZeros, uint32_t k);
+  //! Reports a failed VLC read of a codeword with nofCodeBits bits (0 if invalid). Returns 0.
+  uint64_t vlcFailed(uint32_t nofCodeBits, uint32_t maxCodeBits);
+  //! Reads an escapedValue() with fields wider than 57 bits in total
+  uint64_t readEscapedValueSlow(uint32_t nBits1, uint32_t nBits2, uint32_t nBits3);
 
-    return result;
-  }
+  //! Returns a mask with the nnofBits (0 to 63) least significant bits set
+  static uint64_t lowBitMask(uint32_t nnofBits) { return (uint64_t{1} << nnofBits) - 1u; }
 
-  template <typename T>
-  T signed_read(uint32_t nnofBits) {
-    using unsigned_T = typename std::make_unsigned<T>::type;
+  //! Creates a parser for the range [beginPos, endPos) of state's buffer (used by SubParser)
+  CBasicBitParser(const impl::SBitReadCache<PosT, BitOrderT>& state, PosT beginPos, PosT endPos,
+                  EErrorMode errorMode, EBitError error);
 
-    // Sanity check
-    if (nnofBits == 0) {
-      return 0;
-    }
+ private:
+  //! The read state incl. buffer and cache register
+  impl::SBitReadCache<PosT, BitOrderT> m_state;
+  //! Number of valid bits. If m_nofvalidBits == 0, size() on m_buffer must be used instead. Always
+  //! use nofvalidBits() instead of this variable.
+  PosT m_nofValidBits;
+  //! Bit position in the buffer at which this parser starts (not 0 for sub parsers)
+  PosT m_beginPos;
+  //! Error handling mode
+  EErrorMode m_errorMode;
+  //! Sticky error code in latching mode
+  EBitError m_error;
+};
+
+/*!
+ * @brief Parser for a nested element, created by CBasicBitParser::subParser
+ *
+ * The sub parser is a full parser for the element range and can be passed to all functions taking a
+ * parser reference. On destruction it moves its parent to the end of the element and hands a
+ * latched error over to the parent.
+ */
+template <typename PosT, typename BitOrderT>
+class CBasicBitParser<PosT, BitOrderT>::SubParser : public CBasicBitParser<PosT, BitOrderT> {
+ public:
+  //! Move constructor, the moved-from sub parser does not update the parent anymore
+  SubParser(SubParser&& other)
+      : CBasicBitParser(other.m_state, other.m_beginPos, other.m_nofValidBits, other.m_errorMode,
+                        other.m_error),
+        m_parent(other.m_parent) {
+    other.m_parent = nullptr;
+  }
+
+  //! Moves the parent parser to the end of the element
+  ~SubParser() { finish(); }
 
-    // Mask for signed variable
-    unsigned_T mask = static_cast<unsigned_T>(static_cast<uint64_t>(0xFFFFFFFFFFFFFFFF)
-                                              << static_cast<uint32_t>(nnofBits - 1));
+  //! Disallow copy constructor
+  SubParser(const SubParser&) = delete;
 
-    // Do actual read operation
-    auto tmpRead = read<unsigned_T>(nnofBits);
+  //! Disallow assignment operator
+  SubParser& operator=(const SubParser&) = delete;
 
-    // Check for sign
-    if ((tmpRead & mask) != 0) {
-      tmpRead |= mask;
+  //! Function to move the parent parser to the end of the element and detach from it
+  void finish() {
+    if (m_parent != nullptr) {
+      if (m_parent->m_error == EBitError::none) {
+        m_parent->m_error = this->m_error;
+      }
+      m_parent->skip(this->m_nofValidBits - m_parent->m_state.pos);
+      m_parent = nullptr;
     }
-
-    return static_cast<T>(tmpRead);
   }
 
  private:
-  //! The buffer that stores the data
-  const uint8_t* m_buffer;
-  //! The read pointer
-  uint32_t m_readIter;
-  //! The number of read bits in current byte (max 7)
-  uint32_t m_localReadBits;
-  //! Number of valid bits. If m_nofvalidBits == 0, size() on m_buffer must be used instead. Always
-  //! use nofvalidBits() instead of this variable.
-  uint32_t m_nofValidBits;
+  friend class CBasicBitParser;
+
+  SubParser(CBasicBitParser* parent, PosT beginPos, PosT endPos)
+      : CBasicBitParser(parent->m_state, beginPos, endPos, parent->m_errorMode, EBitError::none),
+        m_parent(parent) {}
+
+  //! The parser to update (nullptr if the element exceeded the data)
+  CBasicBitParser* m_parent;
 };
 
+template <typename PosT, typename BitOrderT>
+typename CBasicBitParser<PosT, BitOrderT>::SubParser CBasicBitParser<PosT, BitOrderT>::subParser(
+    PosT nofBits) {
+  if (nofBits > m_nofValidBits - m_state.pos) {
+    readFailed(nofBits, nofBits);
+    SubParser emptyParser(this, m_state.pos, m_state.pos);
+    emptyParser.m_parent = nullptr;
+    return emptyParser;
+  }
+  return SubParser(this, m_state.pos, m_state.pos + nofBits);
+}
+
+extern template class CBasicBitParser<uint32_t, SMsbFirst>;
+extern template class CBasicBitParser<uint64_t, SMsbFirst>;
+extern template class CBasicBitParser<uint32_t, SLsbFirst>;
+extern template class CBasicBitParser<uint64_t, SLsbFirst>;
+
+//! Bit parser with 32 bit positions
+using CBitParser = CBasicBitParser<uint32_t>;
+//! Bit parser with 64 bit positions
+using CBitParser64 = CBasicBitParser<uint64_t>;
+//! Bit parser with 32 bit positions for LSB-first bitstreams
+using CBitParserLsb = CBasicBitParser<uint32_t, SLsbFirst>;
+//! Bit parser with 64 bit positions for LSB-first bitstreams
+using CBitParser64Lsb = CBasicBitParser<uint64_t, SLsbFirst>;
+
 std::ostream& operator<<(std::ostream& s, CBitParser bitparser);
 
 }  // namespace ilo
@@ -0,0 +1,390 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file bitschema.h
+ * @brief Declarative description of bitstream syntax elements
+ */
+
+#pragma once
+
+// System includes
+#include <cstdint>
+#include <type_traits>
+
+// Internal includes
+#include "ilo/bitbuffer.h"
+#include "ilo/bitparser.h"
+
+namespace ilo {
+namespace impl {
+//! Maximum width of adjacent fixed fields which are read or written as one field
+static const uint32_t kMaxBatchBits = 57u;
+
+template <typename... ItemsT>
+struct SSchemaOps;
+
+/*!
+ * Width of the leading fixed fields of ItemsT which fit into kMaxBatchBits bits together, plus
+ * AccBits. Stops at the first item which is not a fixed field.
+ */
+template <uint32_t AccBits, typename... ItemsT>
+struct SBatchBits : std::integral_constant<uint32_t, AccBits> {};
+
+template <uint32_t AccBits, typename FirstT, typename... ItemsT>
+struct SBatchBits<AccBits, FirstT, ItemsT...>
+    : std::conditional<FirstT::kIsFixed && AccBits + FirstT::kNofBits <= kMaxBatchBits,
+                       SBatchBits<AccBits + FirstT::kNofBits, ItemsT...>,
+                       std::integral_constant<uint32_t, AccBits>>::type {};
+
+/*!
+ * Distributes a batch of BatchBits bits over the fixed fields at the start of ItemsT, beginning
+ * at bit Offset of the batch, and continues with the items behind the batch.
+ */
+template <bool Done, uint32_t Offset, uint32_t BatchBits, typename... ItemsT>
+struct SBatchOps;
+
+template <uint32_t Offset, uint32_t BatchBits, typename... ItemsT>
+struct SBatchOps<true, Offset, BatchBits, ItemsT...> {
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, uint64_t /*batch*/, StructT& s) {
+    SSchemaOps<ItemsT...>::read(parser, s);
+  }
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, uint64_t batch, const StructT& s) {
+    buffer.template write<BatchBits>(batch);
+    SSchemaOps<ItemsT...>::write(buffer, s);
+  }
+};
+
+template <uint32_t Offset, uint32_t BatchBits, typename FieldT, typename... ItemsT>
+struct SBatchOps<false, Offset, BatchBits, FieldT, ItemsT...> {
+  static const uint32_t kNextOffset = Offset + FieldT::kNofBits;
+  using NextOps = SBatchOps<kNextOffset == BatchBits, kNextOffset, BatchBits, ItemsT...>;
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, uint64_t batch, StructT& s) {
+    FieldT::assign(s, BitOrderT::extractField(batch, BatchBits, Offset, FieldT::kNofBits));
+    NextOps::read(parser, batch, s);
+  }
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, uint64_t batch, const StructT& s) {
+    NextOps::write(buffer, BitOrderT::join(batch, Offset, FieldT::bits(s), FieldT::kNofBits), s);
+  }
+};
+
+//! Reads or writes the first item on its own, used for items which are not batched
+template <bool Batched, typename... ItemsT>
+struct SItemOps;
+
+template <typename FirstT, typename... ItemsT>
+struct SItemOps<false, FirstT, ItemsT...> {
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, StructT& s) {
+    FirstT::read(parser, s);
+    SSchemaOps<ItemsT...>::read(parser, s);
+  }
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, const StructT& s) {
+    FirstT::write(buffer, s);
+    SSchemaOps<ItemsT...>::write(buffer, s);
+  }
+};
+
+template <typename... ItemsT>
+struct SItemOps<true, ItemsT...> {
+  static const uint32_t kBatchBits = SBatchBits<0, ItemsT...>::value;
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, StructT& s) {
+    uint64_t batch = parser.template read<uint64_t, kBatchBits>();
+    SBatchOps<false, 0, kBatchBits, ItemsT...>::read(parser, batch, s);
+  }
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, const StructT& s) {
+    SBatchOps<false, 0, kBatchBits, ItemsT...>::write(buffer, 0, s);
+  }
+};
+
+//! Reads or writes a list of schema items in order
+template <>
+struct SSchemaOps<> {
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& /*parser*/, StructT& /*s*/) {}
+
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& /*buffer*/, const StructT& /*s*/) {}
+};
+
+template <typename FirstT, typename... ItemsT>
+struct SSchemaOps<FirstT, ItemsT...>
+    : SItemOps<(SBatchBits<0, FirstT, ItemsT...>::value > 0), FirstT, ItemsT...> {};
+}  // namespace impl
+
+/*!
+ * @brief Schema item: a fixed width field stored in a member of StructT
+ *
+ * Use the ILO_BIT_FIELD macro to declare it. Signed members are sign-extended on reading. Fields
+ * of up to 57 bits are batched with adjacent fixed fields.
+ */
+template <typename StructT, typename ValueT, ValueT StructT::*Member, uint32_t NofBits>
+struct SBitField {
+  static_assert(std::is_integral<ValueT>::value, "Bit fields must have an integer type");
+  static_assert(NofBits >= 1u && NofBits <= sizeof(ValueT) * 8u,
+                "Number of bits does not fit into the type of the member");
+
+  //! Width of the field in bits
+  static const uint32_t kNofBits = NofBits;
+  //! True if the field can be batched with adjacent fixed fields
+  static const bool kIsFixed = NofBits <= impl::kMaxBatchBits;
+
+  //! Stores the right-aligned bits of the field in the member
+  static void assign(StructT& s, uint64_t bits) {
+    s.*Member = impl::castBits<ValueT>(bits, NofBits);
+  }
+
+  //! Returns the value of the member as right-aligned bits of the field
+  static uint64_t bits(const StructT& s) {
+    return static_cast<uint64_t>(s.*Member) & (~uint64_t{0} >> (64u - NofBits));
+  }
+
+  //! Reads the field on its own
+  template <typename PosT, typename BitOrderT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, StructT& s) {
+    s.*Member = parser.template read<ValueT, NofBits>();
+  }
+
+  //! Writes the field on its own
+  template <typename PosT, typename BitOrderT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, const StructT& s) {
+    buffer.template write<NofBits>(bits(s));
+  }
+};
+
+/*!
+ * @brief Schema item: a nested syntax element stored in a member of StructT
+ *
+ * SchemaT is the ilo::CBitSchema of the member type. Use the ILO_BIT_NESTED macro to declare it.
+ */
+template <typename StructT, typename ValueT, ValueT StructT::*Member, typename SchemaT>
+struct SBitNested {
+  //! Nested elements are never batched
+  static const uint32_t kNofBits = 0;
+  //! Nested elements are never batched
+  static const bool kIsFixed = false;
+
+  //! Reads the nested element
+  template <typename PosT, typename BitOrderT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, StructT& s) {
+    SchemaT::read(parser, s.*Member);
+  }
+
+  //! Writes the nested element
+  template <typename PosT, typename BitOrderT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, const StructT& s) {
+    SchemaT::write(buffer, s.*Member);
+  }
+};
+
+/*!
+ * @brief Schema item: items which are only present if a condition holds
+ *
+ * ConditionT provides <tt>static bool check(const StructT&)</tt>, which may use all members read
+ * before. The items are batched among themselves, but not with the items around the condition.
+ *
+ * @code
+ * struct SLoudnessFlagSet {
+ *   static bool check(const SLoudnessInfo& s) { return s.methodDefinition >= 7; }
+ * };
+ * using Schema = ilo::CBitSchema<SLoudnessInfo,
+ *     ILO_BIT_FIELD(SLoudnessInfo, methodDefinition, 4),
+ *     ilo::SBitIf<SLoudnessFlagSet, ILO_BIT_FIELD(SLoudnessInfo, reliability, 2)>>;
+ * @endcode
+ */
+template <typename ConditionT, typename... ItemsT>
+struct SBitIf {
+  //! Conditional items are never batched with the items around them
+  static const uint32_t kNofBits = 0;
+  //! Conditional items are never batched with the items around them
+  static const bool kIsFixed = false;
+
+  //! Reads the items if the condition holds
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, StructT& s) {
+    if (ConditionT::check(s)) {
+      impl::SSchemaOps<ItemsT...>::read(parser, s);
+    }
+  }
+
+  //! Writes the items if the condition holds
+  template <typename PosT, typename BitOrderT, typename StructT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, const StructT& s) {
+    if (ConditionT::check(s)) {
+      impl::SSchemaOps<ItemsT...>::write(buffer, s);
+    }
+  }
+};
+
+//! Condition for ilo::SBitIf which holds if the member is not 0, e.g. a presence flag
+template <typename StructT, typename ValueT, ValueT StructT::*Member>
+struct SBitIsSet {
+  //! Checks the member
+  static bool check(const StructT& s) { return s.*Member != 0; }
+};
+
+/*!
+ * @brief Declarative description of a syntax element
+ *
+ * Describes how the members of StructT are stored in a bitstream with a list of schema items
+ * (ilo::SBitField, ilo::SBitNested and ilo::SBitIf). The same description generates the parser
+ * and the writer, so the two cannot diverge.
+ *
+ * Adjacent fixed fields with a total width of up to 57 bits are read and written as one field,
+ * with the widths and offsets resolved at compile time. As a consequence, a read which runs out
+ * of data fails for the whole batch and not after its first fields.
+ *
+ * <b>Example</b><br>
+ * @code
+ * struct SMhasPacketHeader {
+ *   uint8_t type;
+ *   bool hasLabel;
+ *   uint16_t label;
+ *   uint16_t length;
+ * };
+ *
+ * using MhasPacketHeaderSchema = ilo::CBitSchema<SMhasPacketHeader,
+ *     ILO_BIT_FIELD(SMhasPacketHeader, type, 6),
+ *     ILO_BIT_FIELD(SMhasPacketHeader, hasLabel, 1),
+ *     ilo::SBitIf<ILO_BIT_IS_SET(SMhasPacketHeader, hasLabel),
+ *                 ILO_BIT_FIELD(SMhasPacketHeader, label, 11)>,
+ *     ILO_BIT_FIELD(SMhasPacketHeader, length, 16)>;
+ *
+ * SMhasPacketHeader header = MhasPacketHeaderSchema::read(parser);
+ * MhasPacketHeaderSchema::write(bitbuffer, header);
+ * @endcode
+ *
+ * \ingroup bittools
+ */
+template <typename StructT, typename... ItemsT>
+class CBitSchema {
+ public:
+  //! Type of the described syntax element
+  using StructType = StructT;
+
+  //! Function to read the members of s from the parser
+  template <typename PosT, typename BitOrderT>
+  static void read(CBasicBitParser<PosT, BitOrderT>& parser, StructT& s) {
+    impl::SSchemaOps<ItemsT...>::read(parser, s);
+  }
+
+  //! Function to read a value initialized StructT from the parser
+  template <typename PosT, typename BitOrderT>
+  static StructT read(CBasicBitParser<PosT, BitOrderT>& parser) {
+    StructT s = StructT();
+    read(parser, s);
+    return s;
+  }
+
+  //! Function to write the members of s to the bit buffer
+  template <typename PosT, typename BitOrderT>
+  static void write(CBasicBitBuffer<PosT, BitOrderT>& buffer, const StructT& s) {
+    impl::SSchemaOps<ItemsT...>::write(buffer, s);
+  }
+};
+}  // namespace ilo
+
+//! Declares an ilo::SBitField for member of StructT with nofBits bits
+#define ILO_BIT_FIELD(StructT, member, nofBits) \
+  ::ilo::SBitField<StructT, decltype(StructT::member), &StructT::member, nofBits>
+
+//! Declares an ilo::SBitNested for member of StructT described by SchemaT
+#define ILO_BIT_NESTED(StructT, member, SchemaT) \
+  ::ilo::SBitNested<StructT, decltype(StructT::member), &StructT::member, SchemaT>
+
+//! Declares an ilo::SBitIsSet condition for member of StructT
+#define ILO_BIT_IS_SET(StructT, member) \
+  ::ilo::SBitIsSet<StructT, decltype(StructT::member), &StructT::member>
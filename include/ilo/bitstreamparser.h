@@ -0,0 +1,331 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file bitstreamparser.h
+ * @brief Class for reading bits from a stream of chunks.
+ */
+
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Internal includes
+#include "ilo/common_types.h"
+#include "ilo/bittool_utils.h"
+
+namespace ilo {
+/*!
+ * @brief Class for parsing a stream of byte chunks bit-wise
+ *
+ * In contrast to ilo::CBitParser, the data does not have to be available in one contiguous buffer.
+ * Chunks (e.g. network packets) are queued with @ref pushChunk or requested from a refill callback
+ * when a read needs more data. Reads may cross chunk boundaries. Only the up to 8 bytes following
+ * the read position are copied into a 64 bit cache register, the chunks themselves are neither
+ * copied nor concatenated. A chunk is released with the first refill after all of its bytes were
+ * loaded into the cache register, so the memory is bounded by the queued, not yet parsed data.
+ *
+ * Positions are counted in bits since the start of the stream and are always 64 bit wide. Seeking
+ * backwards is not possible.
+ *
+ * <b>Example</b><br>
+ * @code
+ * ilo::CBitStreamParser parser([&socket](ilo::ByteBuffer& chunk) {
+ *   return socket.receive(chunk);  // false at the end of the stream
+ * });
+ * uint8_t syncByte = parser.read<uint8_t>(8);
+ * @endcode
+ *
+ * \ingroup bittools
+ */
+class CBitStreamParser {
+ public:
+  /*!
+   * @brief Callback to request the next chunk
+   *
+   * Called when a read needs more data than queued. The callback fills the given (empty) buffer
+   * and returns true, or returns false if no more data is available.
+   */
+  using RefillCallback = std::function<bool(ByteBuffer& chunk)>;
+
+  //! Create a parser which only reads chunks queued with @ref pushChunk
+  CBitStreamParser();
+
+  //! Create a parser which requests chunks from refillCallback when the queued data runs out
+  explicit CBitStreamParser(RefillCallback refillCallback);
+
+  //! Disallow copy constructor
+  CBitStreamParser(const CBitStreamParser&) = delete;
+
+  //! Disallow assignment operator
+  CBitStreamParser& operator=(const CBitStreamParser&) = delete;
+
+  //! Function to queue a chunk of data without copying it
+  void pushChunk(ByteBuffer&& chunk);
+
+  //! Function to queue a copy of size bytes at data
+  void pushChunk(const uint8_t* data, size_t size);
+
+  /*!
+   * @brief Function to read data from the stream
+   *
+   * Same as CBasicBitParser::read. If the cache register runs empty, it is refilled from the chunk
+   * queue, with a single 64 bit load if the current chunk has at least 8 bytes left.
+   *
+   * @param nnofBits The number of bits to read (max. size of T)
+   * @return The read value
+   *
+   * @note On failure (not enough data and no refill possible) nothing is consumed.
+   */
+  template <typename T>
+  T read(uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > sizeof(T) * 8u) {
+      return static_cast<T>(readError(EBitError::invalidNofBits,
+                                      "Number of bits does not fit into the given variable"));
+    }
+    if (nnofBits == 0) {
+      return static_cast<T>(0);
+    }
+    if (nnofBits > kMaxReadBits) {
+      if (!fetch(nnofBits)) {
+        return static_cast<T>(readError(EBitError::endOfData, "Not enough data left to parse."));
+      }
+      uint64_t high = take(nnofBits - 32u);
+      return impl::castBits<T>((high << 32u) | take(32u), nnofBits);
+    }
+    if (m_cacheBits < nnofBits) {
+      refill();
+      if (m_cacheBits < nnofBits && !fetch(nnofBits)) {
+        return static_cast<T>(readError(EBitError::endOfData, "Not enough data left to parse."));
+      }
+    }
+    return impl::castBits<T>(take(nnofBits), nnofBits);
+  }
+
+  //! Function to read data without consuming it (max. 57 bits)
+  template <typename T>
+  T peek(uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > sizeof(T) * 8u || nnofBits > kMaxReadBits) {
+      return static_cast<T>(readError(EBitError::invalidNofBits,
+                                      "Number of bits does not fit into the given variable"));
+    }
+    if (nnofBits == 0) {
+      return static_cast<T>(0);
+    }
+    if (m_cacheBits < nnofBits) {
+      refill();
+      if (m_cacheBits < nnofBits && !fetch(nnofBits)) {
+        return static_cast<T>(readError(EBitError::endOfData, "Not enough data left to parse."));
+      }
+    }
+    return impl::castBits<T>(m_cache >> (64u - nnofBits), nnofBits);
+  }
+
+  /*!
+   * @brief Function to skip bits
+   *
+   * Whole chunks inside the skipped range are released without being loaded, and chunks are
+   * requested from the refill callback one at a time, so skipping large payloads does not queue
+   * them.
+   *
+   * @note On failure (end of the stream inside the skipped range) all available data is consumed.
+   */
+  void skip(uint64_t nofBits);
+
+  /*!
+   * @brief Function to copy whole bytes from the stream
+   *
+   * At a byte aligned read position the bytes are copied directly from the chunks. Like
+   * @ref skip, chunks are requested from the refill callback one at a time and released once
+   * copied, so reading large payloads does not queue them. Use @ref fetch first if the payload
+   * must be complete before anything is consumed.
+   *
+   * @note On failure (end of the stream inside the read range) all available bytes are copied to
+   * dst and consumed.
+   */
+  void readBytes(uint8_t* dst, size_t nofBytes);
+
+  /*!
+   * @brief Function to make sure a number of bits can be read
+   *
+   * Requests chunks from the refill callback until at least nofBits bits are available. Useful to
+   * check that a complete syntax element (e.g. an MHAS packet) has arrived before parsing it.
+   *
+   * @return True if nofBits bits are available
+   */
+  bool fetch(uint64_t nofBits);
+
+  //! Function to get the number of bits available without calling the refill callback
+  uint64_t nofBitsAvailable() const { return m_cacheBits + m_nofQueuedBytes * 8u; }
+
+  //! Function to get the number of bits read since the start of the stream
+  uint64_t tell() const { return m_pos; }
+
+  //! Function to get the number of queued chunks which were not completely loaded yet
+  size_t nofQueuedChunks() const { return m_chunks.size(); }
+
+  //! Function to select how failed operations are reported (see CBasicBitParser::setErrorMode)
+  void setErrorMode(EErrorMode mode) { m_errorMode = mode; }
+
+  //! Function to get the current error handling mode
+  EErrorMode errorMode() const { return m_errorMode; }
+
+  //! Function to get the sticky error code
+  EBitError error() const { return m_error; }
+
+  //! Function to check whether an error was latched
+  bool hasError() const { return m_error != EBitError::none; }
+
+  //! Function to reset the sticky error code
+  void clearError() { m_error = EBitError::none; }
+
+ private:
+  //! Maximum number of bits which are guaranteed to be in the cache register after a refill
+  static const uint32_t kMaxReadBits = 57u;
+
+  //! Takes 1 to 57 bits from the cache register, refilling it if needed. No checks.
+  uint64_t take(uint32_t nnofBits) {
+    if (m_cacheBits < nnofBits) {
+      refill();
+    }
+    uint64_t result = m_cache >> (64u - nnofBits);
+    m_cache <<= nnofBits;
+    m_cacheBits -= nnofBits;
+    m_pos += nnofBits;
+    return result;
+  }
+
+  //! Loads as many whole bytes from the queued chunks as fit into the cache register
+  void refill() {
+    if (m_cacheBits <= 56u && m_chunkPos + 8u <= m_chunkSize) {
+      uint32_t nofBytes = (64u - m_cacheBits) >> 3u;
+      uint64_t word = impl::loadBE64(m_chunkData + m_chunkPos);
+      word &= ~uint64_t{0} << (64u - nofBytes * 8u);
+      m_cache |= word >> m_cacheBits;
+      m_cacheBits += nofBytes * 8u;
+      m_chunkPos += nofBytes;
+      m_nofQueuedBytes -= nofBytes;
+      return;
+    }
+    refillSlow();
+  }
+
+  //! Refills the cache register bytewise across chunk boundaries
+  void refillSlow();
+  //! Drops the exhausted front chunk and makes the next one current
+  void popChunk();
+  //! Makes a chunk with unloaded bytes current, requesting one if needed. Returns false if none.
+  bool nextChunk();
+  //! Throws a ReadException or latches the error depending on the error mode. Returns 0.
+  uint64_t readError(EBitError error, const char* msg);
+
+  //! Callback to request more chunks (may be empty)
+  RefillCallback m_refillCallback;
+  //! Queued chunks, the front one is the one currently loaded from
+  std::deque<ByteBuffer> m_chunks;
+  //! Data of the front chunk (nullptr if there is none)
+  const uint8_t* m_chunkData;
+  //! Size of the front chunk
+  size_t m_chunkSize;
+  //! Next byte of the front chunk to load into the cache register
+  size_t m_chunkPos;
+  //! Number of queued bytes not loaded into the cache register yet
+  uint64_t m_nofQueuedBytes;
+  //! Cache register holding the next m_cacheBits bits MSB-aligned, the remaining bits are 0
+  uint64_t m_cache;
+  //! Number of valid bits in the cache register
+  uint32_t m_cacheBits;
+  //! Number of bits read since the start of the stream
+  uint64_t m_pos;
+  //! Error handling mode
+  EErrorMode m_errorMode;
+  //! Sticky error code in latching mode
+  EBitError m_error;
+};
+}  // namespace ilo
@@ -91,8 +91,15 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#include <intrin.h>
+#endif
 
 namespace ilo {
 //! Position type used to indicate relative to what position an operation should be executed.
@@ -105,6 +112,39 @@ enum class EPosType {
   cur
 };
 
+/*!
+ * @brief Error handling mode of bit reader and writer
+ *
+ * In the latching mode failed operations neither log, format nor throw anything. Instead, the first
+ * error is stored as sticky error code which can be queried once for a whole syntax element or
+ * access unit. Failed reads return 0, failed writes and seeks are dropped without changing the
+ * state.
+ */
+enum class EErrorMode {
+  //! Failed operations log an error and throw the matching exception (default)
+  exception = 0,
+  //! Failed operations latch a sticky error code and are ignored otherwise
+  latch
+};
+
+//! Error codes latched by bit reader and writer in ilo::EErrorMode::latch
+enum class EBitError {
+  //! No error occurred
+  none = 0,
+  //! Not enough data left to read
+  endOfData,
+  //! Number of bits does not fit into the given data type
+  invalidNofBits,
+  //! Position is out of the valid range or invalid
+  invalidPosition,
+  //! External buffer is too small for the operation
+  bufferTooSmall,
+  //! Operation not supported for this buffer
+  unsupported,
+  //! Invalid variable length codeword or value not representable by the code
+  invalidCode
+};
+
 //! Custom exception to indicate an issue with a read operation
 struct ReadException : public std::runtime_error {
   //! Create a custom read exception with user message
@@ -146,4 +186,284 @@ struct ReserveException : public std::runtime_error {
   //! Create a custom reserve exception with user message
   ReserveException(const std::string& msg) : std::runtime_error(msg.c_str()) {}
 };
+
+namespace impl {
+//! Reverses the byte order of a 64 bit value
+inline uint64_t byteSwap64(uint64_t value) {
+#if defined(_MSC_VER)
+  return _byteswap_uint64(value);
+#elif defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(value);
+#else
+  value = ((value & 0x00FF00FF00FF00FFull) << 8) | ((value >> 8) & 0x00FF00FF00FF00FFull);
+  value = ((value & 0x0000FFFF0000FFFFull) << 16) | ((value >> 16) & 0x0000FFFF0000FFFFull);
+  return (value << 32) | (value >> 32);
+#endif
+}
+
+//! Counts the leading zero bits of a 64 bit value, returns 64 for 0
+inline uint32_t countLeadingZeros64(uint64_t value) {
+  if (value == 0) {
+    return 64u;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_clzll(value));
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32u))) {
+    return 31u - static_cast<uint32_t>(index);
+  }
+  _BitScanReverse(&index, static_cast<unsigned long>(value));
+  return 63u - static_cast<uint32_t>(index);
+#else
+  uint32_t count = 0;
+  while ((value & (uint64_t{1} << 63u)) == 0) {
+    value <<= 1u;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+//! Counts the trailing zero bits of a 64 bit value, returns 64 for 0
+inline uint32_t countTrailingZeros64(uint64_t value) {
+  if (value == 0) {
+    return 64u;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_ctzll(value));
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanForward(&index, static_cast<unsigned long>(value))) {
+    return static_cast<uint32_t>(index);
+  }
+  _BitScanForward(&index, static_cast<unsigned long>(value >> 32u));
+  return 32u + static_cast<uint32_t>(index);
+#else
+  uint32_t count = 0;
+  while ((value & 1u) == 0) {
+    value >>= 1u;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+//! Reverses the bit order of a 64 bit value
+inline uint64_t reverseBits64(uint64_t value) {
+  value = ((value & 0x5555555555555555ull) << 1) | ((value >> 1) & 0x5555555555555555ull);
+  value = ((value & 0x3333333333333333ull) << 2) | ((value >> 2) & 0x3333333333333333ull);
+  value = ((value & 0x0F0F0F0F0F0F0F0Full) << 4) | ((value >> 4) & 0x0F0F0F0F0F0F0F0Full);
+  return byteSwap64(value);
+}
+
+//! Converts nnofBits (1 to 64) right-aligned bits to T, sign-extending them for signed types
+template <typename T>
+T castBits(uint64_t bits, uint32_t nnofBits) {
+  if (std::is_signed<T>::value && nnofBits < 64u && ((bits >> (nnofBits - 1u)) & 1u) != 0) {
+    bits |= ~uint64_t{0} << nnofBits;
+  }
+  return static_cast<T>(bits);
+}
+
+//! Loads 8 bytes from an arbitrarily aligned address as big-endian 64 bit value
+inline uint64_t loadBE64(const uint8_t* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  return value;
+#else
+  return byteSwap64(value);
+#endif
+}
+
+//! Stores a 64 bit value as 8 big-endian bytes to an arbitrarily aligned address
+inline void storeBE64(uint8_t* data, uint64_t value) {
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ != __ORDER_BIG_ENDIAN__)
+  value = byteSwap64(value);
+#endif
+  std::memcpy(data, &value, sizeof(value));
+}
+
+//! Loads 8 bytes from an arbitrarily aligned address as little-endian 64 bit value
+inline uint64_t loadLE64(const uint8_t* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  return byteSwap64(value);
+#else
+  return value;
+#endif
+}
+
+//! Stores a 64 bit value as 8 little-endian bytes to an arbitrarily aligned address
+inline void storeLE64(uint8_t* data, uint64_t value) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  value = byteSwap64(value);
+#endif
+  std::memcpy(data, &value, sizeof(value));
+}
+
+//! Loads the bytes from bytePos to the end of the buffer as big-endian value padded with zeros
+inline uint64_t loadTailBE64(const uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos) {
+  uint64_t result = 0;
+  uint64_t nofBytesLeft = bytePos < nofBytes ? nofBytes - bytePos : 0u;
+  for (uint32_t i = 0; i < 8u; ++i) {
+    result <<= 8u;
+    if (i < nofBytesLeft) {
+      result |= buffer[bytePos + i];
+    }
+  }
+  return result;
+}
+
+//! Loads the bytes from bytePos to the end of the buffer as little-endian value padded with zeros
+inline uint64_t loadTailLE64(const uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos) {
+  uint64_t result = 0;
+  uint64_t nofBytesLeft = bytePos < nofBytes ? nofBytes - bytePos : 0u;
+  for (uint32_t i = 0; i < 8u && i < nofBytesLeft; ++i) {
+    result |= uint64_t{buffer[bytePos + i]} << (8u * i);
+  }
+  return result;
+}
+
+//! Stores the first bytes of a big-endian value from bytePos up to the end of the buffer
+inline void storeTailBE64(uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos, uint64_t value) {
+  uint64_t nofBytesLeft = bytePos < nofBytes ? nofBytes - bytePos : 0u;
+  for (uint32_t i = 0; i < 8u && i < nofBytesLeft; ++i) {
+    buffer[bytePos + i] = static_cast<uint8_t>(value >> (56u - 8u * i));
+  }
+}
+
+//! Stores the first bytes of a little-endian value from bytePos up to the end of the buffer
+inline void storeTailLE64(uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos, uint64_t value) {
+  uint64_t nofBytesLeft = bytePos < nofBytes ? nofBytes - bytePos : 0u;
+  for (uint32_t i = 0; i < 8u && i < nofBytesLeft; ++i) {
+    buffer[bytePos + i] = static_cast<uint8_t>(value >> (8u * i));
+  }
+}
+}  // namespace impl
+
+/*!
+ * @brief Bit order policy: the first bit of each byte is its most significant bit (default)
+ *
+ * Multi-bit values are stored with their most significant bit first, as in MPEG bitstreams. The
+ * bit order policies provide the word operations of the bit reader and writer engines. Words hold
+ * bits in stream order: for this policy the first bit of the stream is the MSB of the word.
+ */
+struct SMsbFirst {
+  //! True if the first bit of a byte is its most significant bit
+  static const bool kMsbFirst = true;
+
+  //! Loads the 8 bytes at data as word
+  static uint64_t loadWord(const uint8_t* data) { return impl::loadBE64(data); }
+  //! Stores a word to the 8 bytes at data
+  static void storeWord(uint8_t* data, uint64_t word) { impl::storeBE64(data, word); }
+  //! Loads the up to 8 bytes from bytePos to the end of the buffer as word padded with zeros
+  static uint64_t loadTail(const uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos) {
+    return impl::loadTailBE64(buffer, nofBytes, bytePos);
+  }
+  //! Stores a word to the up to 8 bytes from bytePos to the end of the buffer
+  static void storeTail(uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos, uint64_t word) {
+    impl::storeTailBE64(buffer, nofBytes, bytePos, word);
+  }
+  //! Word holding a single byte at its first position
+  static uint64_t byteWord(uint8_t byte) { return uint64_t{byte} << 56u; }
+
+  //! Removes the first nofBits (0 to 63) bits of a word
+  static uint64_t dropBits(uint64_t word, uint32_t nofBits) { return word << nofBits; }
+  //! Returns the first nofBits (1 to 64) bits of a word as value
+  static uint64_t firstBits(uint64_t word, uint32_t nofBits) { return word >> (64u - nofBits); }
+  //! Concatenates the bits of word behind bitOffset (1 to 63) with the first bits of nextWord
+  static uint64_t funnel(uint64_t word, uint64_t nextWord, uint32_t bitOffset) {
+    return (word << bitOffset) | (nextWord >> (64u - bitOffset));
+  }
+  //! Combines two values read one after the other into the value of the whole field
+  static uint64_t join(uint64_t first, uint32_t /*firstNofBits*/, uint64_t second,
+                       uint32_t secondNofBits) {
+    return (first << secondNofBits) | second;
+  }
+  //! Extracts the subfield at offset of a windowBits (max. 57) bit field
+  static uint64_t extractField(uint64_t window, uint32_t windowBits, uint32_t offset,
+                               uint32_t nofBits) {
+    return (window >> (windowBits - offset - nofBits)) & ((uint64_t{1} << nofBits) - 1u);
+  }
+  //! Left shift which places a value of nofBits bits at bitOffset of a word
+  static uint32_t fieldShift(uint32_t bitOffset, uint32_t nofBits) {
+    return 64u - bitOffset - nofBits;
+  }
+  //! Mask of the first nofBits (0 to 8) bits of a byte
+  static uint8_t leadingBitsMask(uint32_t nofBits) {
+    return static_cast<uint8_t>(0xFF00u >> nofBits);
+  }
+  //! Number of 0 bits at the start of a word
+  static uint32_t countLeadingZeros(uint64_t word) { return impl::countLeadingZeros64(word); }
+  //! Converts a word to a word with the first bit of the stream as MSB
+  static uint64_t msbWindow(uint64_t word) { return word; }
+  //! Maps a right-aligned bit sequence (first bit most significant) to the value it is read as
+  static uint64_t sequenceBits(uint64_t bits, uint32_t /*nofBits*/) { return bits; }
+};
+
+/*!
+ * @brief Bit order policy: the first bit of each byte is its least significant bit
+ *
+ * Multi-bit values are stored with their least significant bit first, as in e.g. DEFLATE or some
+ * PCM and metadata formats. Words are little-endian, so the first bit of the stream is the LSB of
+ * the word. Codewords which are defined as bit sequences (Exp-Golomb, unary and VLC codes) are
+ * stored in stream order.
+ */
+struct SLsbFirst {
+  //! True if the first bit of a byte is its most significant bit
+  static const bool kMsbFirst = false;
+
+  //! Loads the 8 bytes at data as word
+  static uint64_t loadWord(const uint8_t* data) { return impl::loadLE64(data); }
+  //! Stores a word to the 8 bytes at data
+  static void storeWord(uint8_t* data, uint64_t word) { impl::storeLE64(data, word); }
+  //! Loads the up to 8 bytes from bytePos to the end of the buffer as word padded with zeros
+  static uint64_t loadTail(const uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos) {
+    return impl::loadTailLE64(buffer, nofBytes, bytePos);
+  }
+  //! Stores a word to the up to 8 bytes from bytePos to the end of the buffer
+  static void storeTail(uint8_t* buffer, uint64_t nofBytes, uint64_t bytePos, uint64_t word) {
+    impl::storeTailLE64(buffer, nofBytes, bytePos, word);
+  }
+  //! Word holding a single byte at its first position
+  static uint64_t byteWord(uint8_t byte) { return uint64_t{byte}; }
+
+  //! Removes the first nofBits (0 to 63) bits of a word
+  static uint64_t dropBits(uint64_t word, uint32_t nofBits) { return word >> nofBits; }
+  //! Returns the first nofBits (1 to 64) bits of a word as value
+  static uint64_t firstBits(uint64_t word, uint32_t nofBits) {
+    return word & (~uint64_t{0} >> (64u - nofBits));
+  }
+  //! Concatenates the bits of word behind bitOffset (1 to 63) with the first bits of nextWord
+  static uint64_t funnel(uint64_t word, uint64_t nextWord, uint32_t bitOffset) {
+    return (word >> bitOffset) | (nextWord << (64u - bitOffset));
+  }
+  //! Combines two values read one after the other into the value of the whole field
+  static uint64_t join(uint64_t first, uint32_t firstNofBits, uint64_t second,
+                       uint32_t /*secondNofBits*/) {
+    return first | (second << firstNofBits);
+  }
+  //! Extracts the subfield at offset of a windowBits (max. 57) bit field
+  static uint64_t extractField(uint64_t window, uint32_t /*windowBits*/, uint32_t offset,
+                               uint32_t nofBits) {
+    return (window >> offset) & ((uint64_t{1} << nofBits) - 1u);
+  }
+  //! Left shift which places a value of nofBits bits at bitOffset of a word
+  static uint32_t fieldShift(uint32_t bitOffset, uint32_t /*nofBits*/) { return bitOffset; }
+  //! Mask of the first nofBits (0 to 8) bits of a byte
+  static uint8_t leadingBitsMask(uint32_t nofBits) {
+    return static_cast<uint8_t>(0xFFu >> (8u - nofBits));
+  }
+  //! Number of 0 bits at the start of a word
+  static uint32_t countLeadingZeros(uint64_t word) { return impl::countTrailingZeros64(word); }
+  //! Converts a word to a word with the first bit of the stream as MSB
+  static uint64_t msbWindow(uint64_t word) { return impl::reverseBits64(word); }
+  //! Maps a right-aligned bit sequence (first bit most significant) to the value it is read as
+  static uint64_t sequenceBits(uint64_t bits, uint32_t nofBits) {
+    return impl::reverseBits64(bits) >> (64u - nofBits);
+  }
+};
 }  // namespace ilo
@@ -0,0 +1,258 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file crc.h
+ * @brief Table driven CRC calculation over byte buffers and bit ranges
+ */
+
+#pragma once
+
+// System includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Internal includes
+#include "ilo/bitbuffer.h"
+#include "ilo/bitparser.h"
+#include "common_types.h"
+
+namespace ilo {
+//! Predefined CRC algorithms
+enum class ECrcType {
+  //! CRC-16 of MPEG-H MHAS, polynomial 0x8005, init 0xFFFF, not reflected
+  crc16,
+  //! CRC-32 of MPEG-2 systems and MPEG-H MHAS, polynomial 0x04C11DB7, init 0xFFFFFFFF
+  crc32Mpeg2,
+  //! CRC-32 of zlib and Ethernet, reflected polynomial 0x04C11DB7, init and xorOut 0xFFFFFFFF
+  crc32,
+  //! CRC-32C (Castagnoli), reflected polynomial 0x1EDC6F41, init and xorOut 0xFFFFFFFF
+  crc32c
+};
+
+//! Parameters of a CRC algorithm (Rocksoft model with refIn == refOut)
+struct SCrcParams {
+  //! Width of the CRC in bits (1 to 32)
+  uint32_t nofBits;
+  //! Generator polynomial in normal notation without the leading bit
+  uint32_t polynomial;
+  //! Initial register value in normal notation
+  uint32_t init;
+  //! True if the bits of each byte are processed starting with the least significant bit
+  bool reflected;
+  //! Value XORed to the final register value
+  uint32_t xorOut;
+};
+
+namespace impl {
+//! Slice-by-8 lookup tables of a CRC algorithm
+struct SCrcTables;
+}  // namespace impl
+
+/*!
+ * @brief Class for calculating a CRC incrementally
+ *
+ * Bytes are processed 8 at a time with slice-by-8 lookup tables. If the compiler targets SSE4.2
+ * (CRC-32C) or the ARMv8 CRC extension (CRC-32 and CRC-32C), the CRC instructions are used
+ * instead. The tables of the predefined algorithms are created once and shared by all instances,
+ * so copying an instance is cheap.
+ *
+ * Bit ranges are processed as if read in groups of 8 bits, with a partial group at the end: each
+ * group is processed like a byte of that value, the partial group like the last bits of such a
+ * byte. For byte aligned ranges, this is the same as the CRC of the bytes.
+ *
+ * <b>Example</b><br>
+ * @code
+ * ilo::CCrc crc(ilo::ECrcType::crc16);
+ * crc.update(payload.data(), payload.size());
+ * uint16_t checksum = static_cast<uint16_t>(crc.value());
+ * @endcode
+ *
+ * \ingroup bittools
+ */
+class CCrc {
+ public:
+  //! Create a CRC calculation for a predefined algorithm
+  explicit CCrc(ECrcType type);
+
+  /*!
+   * @brief Create a CRC calculation for a custom algorithm
+   *
+   * @note Throws std::invalid_argument if the width is out of range or the polynomial or the
+   * initial value have more bits than the CRC.
+   */
+  explicit CCrc(const SCrcParams& params);
+
+  //! Function to restart the calculation with the initial value
+  void reset();
+
+  //! Function to process size bytes at data
+  void update(const uint8_t* data, size_t size);
+
+  //! Function to process all bytes of a byte buffer
+  void update(const ByteBuffer& buffer) { update(buffer.data(), buffer.size()); }
+
+  /*!
+   * @brief Function to process a group of bits
+   *
+   * @param bits The bits right aligned, a value read with that width from a bit parser
+   * @param nnofBits Number of bits (0 to 64)
+   */
+  void updateBits(uint64_t bits, uint32_t nnofBits);
+
+  /*!
+   * @brief Function to process the next bits of a bit parser
+   *
+   * The bits are consumed. Byte aligned bytes are processed in place, unaligned ones are copied
+   * in blocks with CBasicBitParser::bytesView first.
+   *
+   * @param parser Parser positioned at the first bit of the range
+   * @param nofBits Number of bits in the range
+   *
+   * @note If the parser has not enough bits left, it reports the error according to its error
+   * mode and the CRC value is unspecified.
+   */
+  template <typename PosT, typename BitOrderT>
+  void update(CBasicBitParser<PosT, BitOrderT>& parser, PosT nofBits) {
+    ByteBuffer scratch;
+    const PosT maxBlockBytes = kMaxBlockBytes;
+    PosT nofBytesLeft = nofBits / 8u;
+    while (nofBytesLeft != 0) {
+      size_t blockBytes = static_cast<size_t>(std::min(nofBytesLeft, maxBlockBytes));
+      SBytesView view = parser.bytesView(blockBytes, scratch);
+      if (view.data == nullptr) {
+        return;
+      }
+      update(view.data, view.size);
+      nofBytesLeft -= static_cast<PosT>(blockBytes);
+    }
+    uint32_t nofTailBits = static_cast<uint32_t>(nofBits % 8u);
+    if (nofTailBits != 0) {
+      updateBits(parser.template read<uint8_t>(nofTailBits), nofTailBits);
+    }
+  }
+
+  //! Function to process all bits of a bit buffer, see @ref update(CBasicBitParser&, PosT)
+  template <typename PosT, typename BitOrderT>
+  void update(CBasicBitBuffer<PosT, BitOrderT>& buffer) {
+    PosT nofBits = buffer.nofBits();
+    const uint8_t* data = buffer.bufferPtr();
+    update(data, static_cast<size_t>(nofBits / 8u));
+    uint32_t nofTailBits = static_cast<uint32_t>(nofBits % 8u);
+    if (nofTailBits != 0) {
+      uint64_t tail = BitOrderT::byteWord(data[nofBits / 8u]);
+      updateBits(BitOrderT::firstBits(tail, nofTailBits), nofTailBits);
+    }
+  }
+
+  //! Function to get the CRC of the data processed so far
+  uint32_t value() const;
+
+ private:
+  //! Implementation used for the bytes
+  enum class EEngine { table, crc32cInstruction, crc32Instruction };
+
+  //! Maximum number of bytes taken from a bit parser at once
+  static const size_t kMaxBlockBytes = 4096u;
+
+  //! Selects the implementation and sets the initial register value
+  void init();
+  //! Processes bytes with the slice-by-8 tables
+  void updateTable(const uint8_t* data, size_t size);
+  //! Processes a single bit
+  void updateBit(uint32_t bit);
+
+  //! Parameters of the algorithm
+  SCrcParams m_params;
+  //! Lookup tables of the algorithm, shared between copies
+  std::shared_ptr<const impl::SCrcTables> m_tables;
+  //! Implementation used for the bytes
+  EEngine m_engine;
+  //! Initial register value
+  uint32_t m_initRegister;
+  //! The CRC register: left aligned if not reflected, right aligned and reflected otherwise
+  uint32_t m_register;
+};
+}  // namespace ilo
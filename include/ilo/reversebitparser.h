@@ -0,0 +1,392 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file reversebitparser.h
+ * @brief Class for reading bits from the end of a byte buffer toward its start.
+ */
+
+#pragma once
+
+// System includes
+#include <type_traits>
+
+// Internal includes
+#include "ilo/common_types.h"
+#include "ilo/bittool_utils.h"
+
+namespace ilo {
+namespace impl {
+/*!
+ * @brief Cache register engine of the reverse bit readers
+ *
+ * Mirror image of ilo::impl::SBitReadCache: keeps the bits preceding the read position in the 64
+ * bit register, with the bit right before the read position at the LSB for ilo::SMsbFirst and at
+ * the MSB for ilo::SLsbFirst. The register is refilled with a single unaligned 64 bit load of the
+ * bytes ending at the read position. Loads never access memory in front of the buffer.
+ */
+template <typename PosT, typename BitOrderT = SMsbFirst>
+struct SBitReverseReadCache {
+  //! Maximum number of bits which can be taken from the cache register after a single refill
+  static const uint32_t kMaxReadBits = 57u;
+  //! Register operations for reading toward lower addresses (those of the opposite bit order)
+  using ShiftT = typename std::conditional<BitOrderT::kMsbFirst, SLsbFirst, SMsbFirst>::type;
+
+  //! The buffer that stores the data
+  const uint8_t* buffer;
+  //! Cache register holding the cacheBits bits in front of the read position
+  uint64_t cache;
+  //! The read position in bits, the next read ends here
+  PosT pos;
+  //! Number of valid bits in the cache register
+  uint32_t cacheBits;
+
+  //! Sets the read position and invalidates the cache register
+  void reset(PosT newPos) {
+    pos = newPos;
+    cache = 0u;
+    cacheBits = 0u;
+  }
+
+  //! Reloads the cache register from the current read position
+  void refill() {
+    PosT endByte = (pos + 7u) >> 3u;
+    uint64_t word = 0u;
+    if (endByte >= 8u) {
+      word = BitOrderT::loadWord(buffer + endByte - 8u);
+    } else if (endByte > 0u) {
+      // move the first endByte bytes to the end of the word, padded with zeros in front
+      word = ShiftT::dropBits(BitOrderT::loadTail(buffer, endByte, 0u),
+                              8u * static_cast<uint32_t>(8u - endByte));
+    }
+    uint32_t trailingBits = (8u - static_cast<uint32_t>(pos & 0x07u)) & 0x07u;
+    cache = ShiftT::dropBits(word, trailingBits);
+    cacheBits = 64u - trailingBits;
+  }
+
+  //! Takes the 1 to kMaxReadBits bits in front of the read position from the cache register
+  uint64_t read(uint32_t nnofBits) {
+    if (cacheBits < nnofBits) {
+      refill();
+    }
+    uint64_t result = ShiftT::firstBits(cache, nnofBits);
+    cache = ShiftT::dropBits(cache, nnofBits);
+    cacheBits -= nnofBits;
+    pos -= nnofBits;
+    return result;
+  }
+
+  //! Returns the 1 to kMaxReadBits bits in front of the read position without consuming them
+  uint64_t peek(uint32_t nnofBits) {
+    if (cacheBits < nnofBits) {
+      refill();
+    }
+    return ShiftT::firstBits(cache, nnofBits);
+  }
+
+  //! Consumes 0 to kMaxReadBits bits which are already in the cache register
+  void consume(uint32_t nnofBits) {
+    cache = ShiftT::dropBits(cache, nnofBits);
+    cacheBits -= nnofBits;
+    pos -= nnofBits;
+  }
+
+  //! Takes 1 to 64 bits, values wider than kMaxReadBits are read in two parts (last part first)
+  uint64_t readAny(uint32_t nnofBits) {
+    if (nnofBits <= kMaxReadBits) {
+      return read(nnofBits);
+    }
+    uint64_t second = read(32u);
+    uint64_t first = read(nnofBits - 32u);
+    return BitOrderT::join(first, nnofBits - 32u, second, 32u);
+  }
+};
+}  // namespace impl
+
+/*!
+ * @brief Class for parsing a byte buffer bit-wise from its end toward its start
+ *
+ * Some payloads are written forward but have to be decoded backward, e.g. the state of ANS style
+ * entropy coders or trailing fields whose size is stored at the very end of a buffer. This parser
+ * starts at the end of the valid data and each read returns the field that ends at the read
+ * position, then moves the read position in front of it. So the fields written by
+ * ilo::CBasicBitBuffer are returned in reverse order, but each with its original value and without
+ * bit-reversing or copying the buffer.
+ *
+ * Positions are bit positions from the start of the buffer, as for ilo::CBasicBitParser. The read
+ * position starts at @ref nofBits and the parser reaches @ref eof at position 0.
+ *
+ * <b>Example</b><br>
+ * @code
+ * // the writer appended a 16 bit trailer length as the last field
+ * ilo::CReverseBitParser parser(buffer);
+ * uint16_t trailerBits = parser.read<uint16_t>(16);
+ * uint32_t lastValue = parser.read<uint32_t>(20);
+ * @endcode
+ *
+ * @tparam PosT Type of bit positions and sizes. Use the aliases ilo::CReverseBitParser (32 bit)
+ * and ilo::CReverseBitParser64 (64 bit).
+ * @tparam BitOrderT Bit order policy of the data, ilo::SMsbFirst (default) or ilo::SLsbFirst.
+ *
+ * \ingroup bittools
+ */
+template <typename PosT, typename BitOrderT = SMsbFirst>
+class CBasicReverseBitParser {
+  static_assert(std::is_same<PosT, uint32_t>::value || std::is_same<PosT, uint64_t>::value,
+                "Bit positions must be either uint32_t or uint64_t");
+
+ public:
+  //! Unsigned type of bit positions and sizes
+  using PosType = PosT;
+  //! Signed type of relative bit positions
+  using OffsetType = typename std::make_signed<PosT>::type;
+
+  /*!
+   * @brief Create parser from a byte buffer
+   *
+   * The byte buffer will not be copied or changed.
+   *
+   * @param externalBuffer The external buffer which will be parsed
+   * @param nofValidBits The number of valid bits in the buffer, reading starts behind the last of
+   * them. If 0, the whole buffer is considered to contain valid data.
+   */
+  CBasicReverseBitParser(const ByteBuffer& externalBuffer, PosT nofValidBits = 0);
+
+  /*!
+   * @brief Create parser from a data pointer
+   *
+   * Data will not be copied or changed.
+   *
+   * @param buffer A pointer to the first byte of the buffer
+   * @param nofValidBits The number of valid bits in the buffer, reading starts behind the last of
+   * them.
+   */
+  CBasicReverseBitParser(const uint8_t* buffer, PosT nofValidBits);
+
+  //! Disallow copy constructor
+  CBasicReverseBitParser(const CBasicReverseBitParser& copyBuffer) = delete;
+
+  //! Disallow assignment operator
+  CBasicReverseBitParser& operator=(const CBasicReverseBitParser& copyBuffer) = delete;
+
+  /*!
+   * @brief Function to read the field in front of the read position
+   *
+   * Returns the value of the nnofBits bits ending at the read position, in the same bit order as
+   * ilo::CBasicBitParser would return it, and moves the read position to the start of the field.
+   *
+   * @param nnofBits number of bits to read
+   * @return Primitive of type T containing the read bits
+   */
+  template <typename T>
+  T read(uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > m_state.pos || nnofBits > sizeof(T) * 8u) {
+      return static_cast<T>(readFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u)));
+    }
+    if (nnofBits == 0) {
+      return static_cast<T>(0);
+    }
+    return impl::castBits<T>(m_state.readAny(nnofBits), nnofBits);
+  }
+
+  /*!
+   * @brief Function to read data without any error reporting
+   *
+   * Same as @ref read, but a failed read neither throws nor latches an error.
+   *
+   * @return False if not enough data is left or nnofBits does not fit into T. Nothing is consumed
+   * in that case.
+   */
+  template <typename T>
+  bool tryRead(T& value, uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > m_state.pos || nnofBits > sizeof(T) * 8u) {
+      return false;
+    }
+    value = nnofBits == 0 ? static_cast<T>(0)
+                          : impl::castBits<T>(m_state.readAny(nnofBits), nnofBits);
+    return true;
+  }
+
+  //! Same as @ref read, but without moving the read position
+  template <typename T>
+  T peek(uint32_t nnofBits) {
+    static_assert(std::is_integral<T>::value, "Can only read integer types");
+    if (nnofBits > m_state.pos || nnofBits > sizeof(T) * 8u) {
+      return static_cast<T>(readFailed(nnofBits, static_cast<PosT>(sizeof(T) * 8u)));
+    }
+    if (nnofBits == 0) {
+      return static_cast<T>(0);
+    }
+    if (nnofBits <= impl::SBitReverseReadCache<PosT, BitOrderT>::kMaxReadBits) {
+      return impl::castBits<T>(m_state.peek(nnofBits), nnofBits);
+    }
+    impl::SBitReverseReadCache<PosT, BitOrderT> state = m_state;
+    return impl::castBits<T>(state.readAny(nnofBits), nnofBits);
+  }
+
+  /*!
+   * @brief Function to move the read position toward the start of the buffer
+   *
+   * @note On failure the read position is not changed.
+   */
+  void skip(PosT nofBits) {
+    if (nofBits > m_state.pos) {
+      readFailed(nofBits, nofBits);
+      return;
+    }
+    if (nofBits < m_state.cacheBits) {
+      m_state.consume(static_cast<uint32_t>(nofBits));
+    } else {
+      m_state.reset(m_state.pos - nofBits);
+    }
+  }
+
+  /*!
+   * @brief Function to seek to a specified bit position
+   *
+   * Same as ilo::CBasicBitParser::seek, positions are counted from the start of the buffer.
+   */
+  void seek(OffsetType bitposition, ilo::EPosType fromPosition);
+
+  //! Function to get the bit position of the read pointer from the beginning of the buffer
+  PosT tell() const { return m_state.pos; }
+
+  //! Function to get the total buffer size in bits
+  PosT nofBits() const { return m_nofValidBits; }
+
+  //! Function to get the number of bits read, counted from the end of the buffer
+  PosT nofReadBits() const { return m_nofValidBits - m_state.pos; }
+
+  //! Function to get the number of bits left to read (the bits in front of the read position)
+  PosT nofBitsLeft() const { return m_state.pos; }
+
+  //! Function to get end-of-file indication, true if the reader is at the start of the buffer
+  bool eof() const { return m_state.pos == 0; }
+
+  //! Function to select how failed operations are reported (see ilo::CBasicBitParser)
+  void setErrorMode(EErrorMode mode) { m_errorMode = mode; }
+
+  //! Function to get the current error handling mode
+  EErrorMode errorMode() const { return m_errorMode; }
+
+  //! Function to get the sticky error code
+  EBitError error() const { return m_error; }
+
+  //! Function to check whether an error was latched
+  bool hasError() const { return m_error != EBitError::none; }
+
+  //! Function to reset the sticky error code
+  void clearError() { m_error = EBitError::none; }
+
+ private:
+  //! Throws or latches the error of a read which failed the bounds or width check
+  uint64_t readFailed(PosT nnofBits, PosT maxNofBits);
+  //! Throws a SeekException or latches the error depending on the error mode
+  void seekFailed(EBitError error, const char* msg);
+
+  //! The read state
+  impl::SBitReverseReadCache<PosT, BitOrderT> m_state;
+  //! Number of valid bits in the buffer
+  PosT m_nofValidBits;
+  //! Error handling mode
+  EErrorMode m_errorMode;
+  //! Sticky error code in latching mode
+  EBitError m_error;
+};
+
+extern template class CBasicReverseBitParser<uint32_t, SMsbFirst>;
+extern template class CBasicReverseBitParser<uint64_t, SMsbFirst>;
+extern template class CBasicReverseBitParser<uint32_t, SLsbFirst>;
+extern template class CBasicReverseBitParser<uint64_t, SLsbFirst>;
+
+//! Reverse bit parser with 32 bit positions
+using CReverseBitParser = CBasicReverseBitParser<uint32_t>;
+//! Reverse bit parser with 64 bit positions
+using CReverseBitParser64 = CBasicReverseBitParser<uint64_t>;
+//! Reverse bit parser with 32 bit positions for LSB-first bitstreams
+using CReverseBitParserLsb = CBasicReverseBitParser<uint32_t, SLsbFirst>;
+//! Reverse bit parser with 64 bit positions for LSB-first bitstreams
+using CReverseBitParser64Lsb = CBasicReverseBitParser<uint64_t, SLsbFirst>;
+}  // namespace ilo
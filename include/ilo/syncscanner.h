@@ -0,0 +1,177 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file syncscanner.h
+ * @brief Scanner for byte aligned sync words and start codes in a byte buffer
+ */
+
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Internal includes
+#include "ilo/version.h"
+#include "common_types.h"
+
+namespace ilo {
+/*!
+ * @brief Scanner for a byte aligned sync word of 1 to 4 bytes
+ *
+ * Finds the offsets at which a sync word (e.g. the MHAS sync word 0xC001A5 or the start code
+ * 0x000001) starts in a byte buffer. Bits of the sync word can be excluded from the comparison
+ * with a mask.
+ *
+ * One byte of the sync word which has to match completely is used as prefilter: it is searched
+ * with std::memchr, which is vectorized by the C library, and only its hits are verified with a
+ * masked 32 bit comparison. Bytes other than 0x00 and 0xFF are preferred for the prefilter, since
+ * they are rarer in padding and start code prefixes.
+ *
+ * @code
+ * ilo::CSyncWordScanner scanner(0xC001A5, 3);
+ * size_t offset = scanner.findNext(buffer);
+ * if (offset != buffer.size()) {
+ *   // buffer[offset] is the first byte of the sync word
+ * }
+ * @endcode
+ */
+class CSyncWordScanner {
+ public:
+  /*!
+   * @brief Create scanner for a sync word
+   *
+   * @param syncWord The sync word, its first byte is the most significant of the nofBytes bytes
+   * @param nofBytes Length of the sync word in bytes (1 to 4)
+   * @param mask Bits of the sync word which have to match, all by default
+   *
+   * @note Throws std::invalid_argument if nofBytes is out of range or syncWord has more than
+   * nofBytes bytes.
+   */
+  CSyncWordScanner(uint32_t syncWord, uint32_t nofBytes, uint32_t mask = 0xFFFFFFFFu);
+
+  /*!
+   * @brief Function to find the next occurrence of the sync word
+   *
+   * @param data Pointer to the first byte of the data
+   * @param size Size of the data in bytes
+   * @param fromOffset Offset to start the search at
+   * @return Offset of the first sync word starting at or behind fromOffset, or size if there is
+   * none
+   */
+  size_t findNext(const uint8_t* data, size_t size, size_t fromOffset = 0) const;
+
+  //! Same as @ref findNext(const uint8_t*, size_t, size_t) const for a byte buffer
+  size_t findNext(const ByteBuffer& buffer, size_t fromOffset = 0) const;
+
+  /*!
+   * @brief Function to find all occurrences of the sync word
+   *
+   * @return Offsets of all sync words in ascending order, overlapping occurrences included
+   */
+  std::vector<size_t> findAll(const uint8_t* data, size_t size) const;
+
+  //! Same as @ref findAll(const uint8_t*, size_t) const for a byte buffer
+  std::vector<size_t> findAll(const ByteBuffer& buffer) const;
+
+  //! Function to get the length of the sync word in bytes
+  uint32_t nofBytes() const { return m_nofBytes; }
+
+ private:
+  //! Checks the sync word at offset, which must leave at least m_nofBytes bytes
+  bool matchesAt(const uint8_t* data, size_t size, size_t offset) const;
+
+  //! The sync word, left aligned in 32 bits
+  uint32_t m_syncWord;
+  //! The mask of the sync word, left aligned in 32 bits
+  uint32_t m_mask;
+  //! Length of the sync word in bytes
+  uint32_t m_nofBytes;
+  //! Index of the byte used as prefilter, m_nofBytes if no byte has to match completely
+  uint32_t m_anchorIndex;
+  //! Value of the byte used as prefilter
+  uint8_t m_anchorValue;
+};
+}  // namespace ilo
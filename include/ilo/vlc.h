@@ -0,0 +1,235 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+/*!
+ * @file vlc.h
+ * @brief Lookup tables for decoding and encoding variable length codes.
+ */
+
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Internal includes
+#include "ilo/version.h"
+
+namespace ilo {
+/*!
+ * @brief Codeword of a variable length code
+ *
+ * The codeword is stored right-aligned, i.e. the first bit of the codeword is bit nofBits - 1 of
+ * code. The struct is an aggregate, so codebooks can be defined as static constant arrays.
+ */
+struct SVlcCode {
+  //! Right-aligned codeword
+  uint32_t code;
+  //! Length of the codeword in bits (1 to 32)
+  uint32_t nofBits;
+  //! Value represented by the codeword
+  int32_t value;
+};
+
+namespace impl {
+//! Entry of a VLC lookup table
+struct SVlcEntry {
+  //! Decoded value, or offset of the next level table if subTableBits is not 0
+  int32_t value;
+  //! Total length of the codeword, 0 if no codeword starts with the looked up bits
+  uint8_t nofBits;
+  //! Number of bits indexing the next level table, 0 for direct hits
+  uint8_t subTableBits;
+};
+}  // namespace impl
+
+/*!
+ * @brief Decoding and encoding tables for a variable length code (e.g. a Huffman code)
+ *
+ * The tables are built once from a codebook at construction time, so the class is meant to be
+ * created once per codebook (e.g. as function local static) and shared by all readers and writers.
+ *
+ * Decoding uses a multi level lookup: The first rootBits bits of the bitstream index the root
+ * table. Codewords not longer than rootBits are resolved by this single lookup. Longer codewords
+ * share a root entry per prefix, which points to a next level table indexed by the following bits.
+ * Each of these tables is indexed by at most rootBits bits, so the table size stays bounded for
+ * long codewords: A codeword of n bits is resolved with at most ceil(n / rootBits) table accesses,
+ * typically with one or two.
+ *
+ * Encoding uses a table indexed by value if the values are dense enough, and a binary search over
+ * the sorted codebook otherwise.
+ *
+ * <b>Example</b><br>
+ * @code
+ * static const ilo::SVlcCode kCodebook[] = {{0x0, 1, 0}, {0x2, 2, 1}, {0x3, 2, -1}};
+ * static const ilo::CVlcTable table(kCodebook, 3);
+ *
+ * ilo::CBitBuffer bitBuffer;
+ * bitBuffer.writeVlc(table, -1);
+ * ilo::CBitParser bitParser(bitBuffer.bytebuffer());
+ * int32_t value = bitParser.readVlc(table);
+ * @endcode
+ */
+class CVlcTable {
+ public:
+  //! Maximum length of a codeword in bits
+  static const uint32_t kMaxCodeBits = 32u;
+  //! Default number of bits resolved by the root table
+  static const uint32_t kDefaultRootBits = 9u;
+
+  /*!
+   * @brief Builds the lookup tables for the given codebook
+   *
+   * @param codes Array of codewords
+   * @param nofCodes Number of codewords in the array
+   * @param rootBits Number of bits resolved by the root table (1 to 16). It is reduced to the
+   * length of the longest codeword if that one is shorter.
+   *
+   * @throws std::invalid_argument if the codebook is empty, not prefix-free, contains a value
+   * more than once or contains codewords with an invalid length
+   */
+  CVlcTable(const SVlcCode* codes, size_t nofCodes, uint32_t rootBits = kDefaultRootBits);
+
+  //! Same as above for a codebook stored in a vector
+  explicit CVlcTable(const std::vector<SVlcCode>& codes, uint32_t rootBits = kDefaultRootBits);
+
+  //! Length of the longest codeword in bits
+  uint32_t maxCodeBits() const { return m_maxCodeBits; }
+
+  //! Number of bits resolved by the root table
+  uint32_t rootBits() const { return m_rootBits; }
+
+  /*!
+   * @brief Looks up the codeword at the beginning of a MSB-aligned bit window
+   *
+   * @param window Bits to decode, the first bit is the MSB. At least maxCodeBits() bits have to be
+   * valid (or zero padded).
+   * @return The table entry. Its nofBits member is 0 if the window does not start with a codeword.
+   */
+  const impl::SVlcEntry& lookup(uint64_t window) const {
+    size_t rootIndex = static_cast<size_t>(window >> (64u - m_rootBits));
+    const impl::SVlcEntry* entry = &m_decodeTable[rootIndex];
+    uint32_t usedBits = m_rootBits;
+    while (entry->subTableBits != 0) {
+      size_t index = static_cast<size_t>((window << usedBits) >> (64u - entry->subTableBits));
+      usedBits += entry->subTableBits;
+      entry = &m_decodeTable[static_cast<size_t>(entry->value) + index];
+    }
+    return *entry;
+  }
+
+  /*!
+   * @brief Finds the codeword of a value
+   *
+   * @return Pointer to the codeword or nullptr if the value is not part of the codebook
+   */
+  const SVlcCode* find(int32_t value) const {
+    if (!m_denseEncodeTable.empty()) {
+      int64_t index = int64_t{value} - m_minValue;
+      if (index < 0 || index >= static_cast<int64_t>(m_denseEncodeTable.size()) ||
+          m_denseEncodeTable[static_cast<size_t>(index)].nofBits == 0) {
+        return nullptr;
+      }
+      return &m_denseEncodeTable[static_cast<size_t>(index)];
+    }
+    return findSorted(value);
+  }
+
+ private:
+  void init(const SVlcCode* codes, size_t nofCodes, uint32_t rootBits);
+  size_t buildTable(std::vector<const SVlcCode*>& codes, uint32_t usedBits, uint32_t tableBits);
+  void fill(const SVlcCode& code, size_t tableOffset, uint32_t tableBits, uint32_t usedBits);
+  const SVlcCode* findSorted(int32_t value) const;
+
+  //! Root table followed by the tables of all further levels
+  std::vector<impl::SVlcEntry> m_decodeTable;
+  //! Codebook sorted by value
+  std::vector<SVlcCode> m_sortedCodes;
+  //! Codewords indexed by value - m_minValue, empty if the values are too sparse
+  std::vector<SVlcCode> m_denseEncodeTable;
+  int32_t m_minValue;
+  uint32_t m_maxCodeBits;
+  uint32_t m_rootBits;
+};
+}  // namespace ilo
@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+// System includes
+#include <stdexcept>
+
+// Internal includes
+#include "ilo/arithcoder.h"
+#include "ilo_logging.h"
+
+namespace ilo {
+namespace {
+//! Number of bits the decoder reads ahead of the encoder's final flush
+const uint32_t kNofReadAheadBits = 14u;
+}  // namespace
+
+template <typename ParserT>
+CBasicArithDecoder<ParserT>::CBasicArithDecoder(ParserT& parser)
+    : m_parser(parser), m_low(0u), m_high(0xFFFFu), m_value(0u), m_nofPaddingBits(0u) {
+  if (!m_parser.tryRead(m_value, impl::kArithRangeBits)) {
+    m_value = readPadded(impl::kArithRangeBits);
+  }
+}
+
+template <typename ParserT>
+void CBasicArithDecoder<ParserT>::finish() {
+  if (m_nofPaddingBits <= kNofReadAheadBits) {
+    m_parser.seek(-static_cast<int32_t>(kNofReadAheadBits - m_nofPaddingBits), EPosType::cur);
+  } else {
+    // the encoder wrote more bits than available
+    m_parser.skip(m_nofPaddingBits - kNofReadAheadBits);
+  }
+  m_nofPaddingBits = 0;
+}
+
+template <typename ParserT>
+uint32_t CBasicArithDecoder<ParserT>::readPadded(uint32_t nnofBits) {
+  uint32_t nofAvailableBits =
+      static_cast<uint32_t>(std::min<typename ParserT::PosType>(nnofBits, m_parser.nofBitsLeft()));
+  uint32_t bits = 0;
+  if (nofAvailableBits != 0) {
+    bits = m_parser.template read<uint32_t>(nofAvailableBits) << (nnofBits - nofAvailableBits);
+  }
+  m_nofPaddingBits += nnofBits - nofAvailableBits;
+  return bits;
+}
+
+template <typename BufferT>
+CBasicArithEncoder<BufferT>::CBasicArithEncoder(BufferT& buffer)
+    : m_buffer(buffer), m_low(0u), m_high(0xFFFFu), m_nofFollowBits(0u) {}
+
+template <typename BufferT>
+void CBasicArithEncoder<BufferT>::finish() {
+  ++m_nofFollowBits;
+  writeBits(m_low < 0x4000u ? 0u : 1u, 1u);
+  m_low = 0u;
+  m_high = 0xFFFFu;
+}
+
+template <typename BufferT>
+void CBasicArithEncoder<BufferT>::writeBitsSlow(uint32_t bits, uint32_t nnofBits) {
+  uint32_t nofRestBits = nnofBits - 1u;
+  uint32_t firstBit = bits >> nofRestBits;
+  m_buffer.write(firstBit, 1u);
+  uint32_t followBits = firstBit != 0 ? 0u : 0xFFFFFFFFu;
+  while (m_nofFollowBits > 0) {
+    uint32_t chunkBits = static_cast<uint32_t>(std::min<uint64_t>(32u, m_nofFollowBits));
+    m_buffer.write(followBits, chunkBits);
+    m_nofFollowBits -= chunkBits;
+  }
+  if (nofRestBits != 0) {
+    m_buffer.write(bits & ((1u << nofRestBits) - 1u), nofRestBits);
+  }
+}
+
+template <typename BufferT>
+void CBasicArithEncoder<BufferT>::zeroFrequency() {
+  ILO_FAIL_WITH(std::invalid_argument, "Symbol with a frequency of 0 cannot be encoded.");
+}
+
+template class CBasicArithDecoder<CBitParser>;
+template class CBasicArithDecoder<CBitParser64>;
+template class CBasicArithEncoder<CBitBuffer>;
+template class CBasicArithEncoder<CBitBuffer64>;
+}  // namespace ilo
@@ -82,235 +82,574 @@ amm-info@iis.fraunhofer.de
 
 // System includes
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 
 // Internal includes
 #include "ilo/bitbuffer.h"
 #include "ilo_logging.h"
 
 namespace ilo {
-CBitBuffer::CBitBuffer(uint32_t initLengthInBytes)
+namespace {
+//! Minimum capacity of the internal buffer once it has to grow
+const size_t kMinCapacityBytes = 64u;
+
+//! Reads nnofBits (1 to 57) bits at bitPos of a buffer of nofBytes bytes
+template <typename BitOrderT>
+uint64_t peekBits(const uint8_t* buffer, size_t nofBytes, uint64_t bitPos, uint32_t nnofBits) {
+  size_t bytePos = static_cast<size_t>(bitPos >> 3u);
+  uint64_t word = bytePos + 8u <= nofBytes ? BitOrderT::loadWord(buffer + bytePos)
+                                           : BitOrderT::loadTail(buffer, nofBytes, bytePos);
+  return BitOrderT::firstBits(BitOrderT::dropBits(word, bitPos & 0x07u), nnofBits);
+}
+
+//! Overwrites nnofBits (1 to 57) bits at bitPos of a buffer of nofBytes bytes with value
+template <typename BitOrderT>
+void pokeBits(uint8_t* buffer, size_t nofBytes, uint64_t bitPos, uint32_t nnofBits,
+              uint64_t value) {
+  size_t bytePos = static_cast<size_t>(bitPos >> 3u);
+  uint32_t shift = BitOrderT::fieldShift(static_cast<uint32_t>(bitPos & 0x07u), nnofBits);
+  uint64_t mask = (~uint64_t{0} >> (64u - nnofBits)) << shift;
+  if (bytePos + 8u <= nofBytes) {
+    uint64_t word = BitOrderT::loadWord(buffer + bytePos);
+    BitOrderT::storeWord(buffer + bytePos, (word & ~mask) | ((value << shift) & mask));
+  } else {
+    uint64_t word = BitOrderT::loadTail(buffer, nofBytes, bytePos);
+    BitOrderT::storeTail(buffer, nofBytes, bytePos, (word & ~mask) | ((value << shift) & mask));
+  }
+}
+
+//! Loads the 64 bits at bitPos, which must be followed by at least 64 bits of the buffer
+template <typename BitOrderT>
+uint64_t loadBitsAt(const uint8_t* buffer, uint64_t bitPos) {
+  const uint8_t* src = buffer + (bitPos >> 3u);
+  uint32_t bitOffset = static_cast<uint32_t>(bitPos & 0x07u);
+  uint64_t word = BitOrderT::loadWord(src);
+  return bitOffset == 0 ? word : BitOrderT::funnel(word, BitOrderT::byteWord(src[8]), bitOffset);
+}
+
+/*!
+ * Copies nnofBits bits from srcBit of src to dstBit of dst. The buffers may overlap if the
+ * destination is in front of the source. The destination is made byte aligned with a masked field
+ * first, so the bulk is copied in whole bytes or words which never overlap source bits that are
+ * still to be read.
+ */
+template <typename BitOrderT>
+void copyBits(uint8_t* dst, size_t dstNofBytes, uint64_t dstBit, const uint8_t* src,
+              size_t srcNofBytes, uint64_t srcBit, uint64_t nnofBits) {
+  const uint64_t maxFieldBits = 57u;
+  uint64_t headBits = std::min<uint64_t>(nnofBits, (8u - (dstBit & 0x07u)) & 0x07u);
+  if (headBits != 0) {
+    uint32_t n = static_cast<uint32_t>(headBits);
+    pokeBits<BitOrderT>(dst, dstNofBytes, dstBit, n,
+                        peekBits<BitOrderT>(src, srcNofBytes, srcBit, n));
+    dstBit += headBits;
+    srcBit += headBits;
+    nnofBits -= headBits;
+  }
+  if ((srcBit & 0x07u) == 0) {
+    size_t nofWholeBytes = static_cast<size_t>(nnofBits >> 3u);
+    std::memmove(dst + (dstBit >> 3u), src + (srcBit >> 3u), nofWholeBytes);
+    dstBit += nofWholeBytes * 8u;
+    srcBit += nofWholeBytes * 8u;
+    nnofBits -= nofWholeBytes * 8u;
+  } else {
+    for (; nnofBits >= 64u; dstBit += 64u, srcBit += 64u, nnofBits -= 64u) {
+      BitOrderT::storeWord(dst + (dstBit >> 3u), loadBitsAt<BitOrderT>(src, srcBit));
+    }
+  }
+  while (nnofBits != 0) {
+    uint32_t n = static_cast<uint32_t>(std::min(nnofBits, maxFieldBits));
+    pokeBits<BitOrderT>(dst, dstNofBytes, dstBit, n,
+                        peekBits<BitOrderT>(src, srcNofBytes, srcBit, n));
+    dstBit += n;
+    srcBit += n;
+    nnofBits -= n;
+  }
+}
+
+//! Moves nnofBits bits within a buffer of nofBytes bytes from srcBit to dstBit like memmove
+template <typename BitOrderT>
+void moveBits(uint8_t* buffer, size_t nofBytes, uint64_t dstBit, uint64_t srcBit,
+              uint64_t nnofBits) {
+  const uint64_t maxFieldBits = 57u;
+  if (nnofBits == 0 || dstBit == srcBit) {
+    return;
+  }
+  if (dstBit < srcBit) {
+    copyBits<BitOrderT>(buffer, nofBytes, dstBit, buffer, nofBytes, srcBit, nnofBits);
+  } else {
+    // copy from the end, so the source bits are read before they are overwritten
+    uint64_t dstEnd = dstBit + nnofBits;
+    uint64_t srcEnd = srcBit + nnofBits;
+    uint64_t tailBits = std::min<uint64_t>(nnofBits, dstEnd & 0x07u);
+    if (tailBits != 0) {
+      uint32_t n = static_cast<uint32_t>(tailBits);
+      dstEnd -= tailBits;
+      srcEnd -= tailBits;
+      pokeBits<BitOrderT>(buffer, nofBytes, dstEnd, n,
+                          peekBits<BitOrderT>(buffer, nofBytes, srcEnd, n));
+      nnofBits -= tailBits;
+    }
+    if ((srcEnd & 0x07u) == 0) {
+      size_t nofWholeBytes = static_cast<size_t>(nnofBits >> 3u);
+      dstEnd -= nofWholeBytes * 8u;
+      srcEnd -= nofWholeBytes * 8u;
+      nnofBits -= nofWholeBytes * 8u;
+      std::memmove(buffer + (dstEnd >> 3u), buffer + (srcEnd >> 3u), nofWholeBytes);
+    } else {
+      for (; nnofBits >= 64u; nnofBits -= 64u) {
+        dstEnd -= 64u;
+        srcEnd -= 64u;
+        BitOrderT::storeWord(buffer + (dstEnd >> 3u), loadBitsAt<BitOrderT>(buffer, srcEnd));
+      }
+    }
+    while (nnofBits != 0) {
+      uint32_t n = static_cast<uint32_t>(std::min(nnofBits, maxFieldBits));
+      dstEnd -= n;
+      srcEnd -= n;
+      pokeBits<BitOrderT>(buffer, nofBytes, dstEnd, n,
+                          peekBits<BitOrderT>(buffer, nofBytes, srcEnd, n));
+      nnofBits -= n;
+    }
+  }
+}
+
+template <typename ExceptionType>
+void failWith(EErrorMode mode, EBitError& latchedError, EBitError error, const char* msg) {
+  if (mode == EErrorMode::latch) {
+    if (latchedError == EBitError::none) {
+      latchedError = error;
+    }
+    return;
+  }
+  ILO_FAIL_WITH(ExceptionType, "%s", msg);
+}
+}  // namespace
+
+template <typename PosT, typename BitOrderT>
+CBasicBitBuffer<PosT, BitOrderT>::CBasicBitBuffer(PosT initLengthInBytes)
     : m_useExtBuffer(false),
       m_internalBuffer(initLengthInBytes),
       m_buffer(m_internalBuffer.data()),
       m_extBufferSizeBytes(0u),
+      m_sizeBytes(initLengthInBytes),
       m_writeIterBytes(0u),
       m_localWriteBits(0u),
-      m_nofvalidBits(0u) {}
-
-CBitBuffer::CBitBuffer(ilo::ByteBuffer& externalBuffer, uint32_t nofValidBits)
+      m_acc(0u),
+      m_accMergeBits(0u),
+      m_nofvalidBits(0u),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {}
+
+template <typename PosT, typename BitOrderT>
+CBasicBitBuffer<PosT, BitOrderT>::CBasicBitBuffer(ilo::ByteBuffer& externalBuffer,
+                                                  PosT nofValidBits)
     : m_useExtBuffer(true),
       m_buffer(externalBuffer.data()),
       m_extBufferSizeBytes(externalBuffer.size()),
+      m_sizeBytes(0u),
       m_writeIterBytes(0u),
-      m_localWriteBits(0u) {
+      m_localWriteBits(0u),
+      m_acc(0u),
+      m_accMergeBits(0u),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {
   m_nofvalidBits = nofValidBits;
 }
 
-CBitBuffer::CBitBuffer(uint8_t* buffer, size_t sizeBytes, uint32_t nofValidBits)
+template <typename PosT, typename BitOrderT>
+CBasicBitBuffer<PosT, BitOrderT>::CBasicBitBuffer(uint8_t* buffer, size_t sizeBytes,
+                                                  PosT nofValidBits)
     : m_useExtBuffer(true),
       m_buffer(buffer),
       m_extBufferSizeBytes(sizeBytes),
+      m_sizeBytes(0u),
       m_writeIterBytes(0u),
-      m_localWriteBits(0u) {
+      m_localWriteBits(0u),
+      m_acc(0u),
+      m_accMergeBits(0u),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {
   m_nofvalidBits = nofValidBits;
 }
 
-CBitBuffer::CBitBuffer(const CBitBuffer& copyBuffer)
+template <typename PosT, typename BitOrderT>
+CBasicBitBuffer<PosT, BitOrderT>::CBasicBitBuffer(const CBasicBitBuffer& copyBuffer)
     : m_useExtBuffer(copyBuffer.m_useExtBuffer),
       m_internalBuffer(copyBuffer.m_internalBuffer),
-      m_buffer(copyBuffer.m_buffer),
+      m_buffer(m_internalBuffer.data()),
+      m_extBufferSizeBytes(0u),
+      m_sizeBytes(copyBuffer.m_sizeBytes),
       m_writeIterBytes(copyBuffer.m_writeIterBytes),
       m_localWriteBits(copyBuffer.m_localWriteBits),
-      m_nofvalidBits(copyBuffer.m_nofvalidBits) {
+      m_acc(copyBuffer.m_acc),
+      m_accMergeBits(copyBuffer.m_accMergeBits),
+      m_nofvalidBits(copyBuffer.m_nofvalidBits),
+      m_errorMode(copyBuffer.m_errorMode),
+      m_error(copyBuffer.m_error) {
   ILO_ASSERT(!copyBuffer.m_useExtBuffer,
              "BitBuffer copy constructor is not allowed for external buffers.");
+  // the pending bits of the copied accumulator are not stored in the copied buffer yet
+  flushAccumulator();
 }
 
-CBitBuffer::~CBitBuffer() {}
+template <typename PosT, typename BitOrderT>
+CBasicBitBuffer<PosT, BitOrderT>::~CBasicBitBuffer() {
+  flushAccumulator();
+}
 
-void CBitBuffer::write(bool toWrite) {
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::write(bool toWrite) {
   uint8_t value = toWrite;
   write(value, 1);
 }
 
-void CBitBuffer::append(const ilo::ByteBuffer& toAppend) {
-  if (m_useExtBuffer) {
-    ILO_ASSERT_WITH((m_extBufferSizeBytes * 8u) >= nofBits() + toAppend.size() * 8u,
-                    AppendException,
-                    "External Buffer size is not big enough to append the given byte buffer.");
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::writeEscapedValue(uint64_t value, uint32_t nBits1,
+                                                         uint32_t nBits2, uint32_t nBits3) {
+  if (nBits1 > 32u || nBits2 > 32u || nBits3 > 32u) {
+    writeError(EBitError::invalidNofBits, "Fields of escapedValue() exceed 32 bits.");
+    return;
   }
 
-  uint32_t writePosBeforeBits = tell();
-  if (writePosBeforeBits == nofBits()) {
-    writePosBeforeBits += static_cast<uint8_t>(toAppend.size()) * 8u;
+  uint32_t widths[3] = {nBits1, nBits2, nBits3};
+  uint64_t fields[3] = {0u, 0u, 0u};
+  uint32_t nofFields = 0;
+  uint32_t nofBitsTotal = 0;
+  for (uint32_t i = 0; i < 3u && nofFields == 0; ++i) {
+    uint64_t maxValue = (uint64_t{1} << widths[i]) - 1u;
+    nofBitsTotal += widths[i];
+    if (value < maxValue || i == 2u) {
+      if (value > maxValue) {
+        writeError(EBitError::invalidCode, "Value too large for escapedValue().");
+        return;
+      }
+      fields[i] = value;
+      nofFields = i + 1u;
+    } else {
+      fields[i] = maxValue;
+      value -= maxValue;
+    }
   }
 
-  seek(0u, ilo::EPosType::end);
+  if (!canWrite(nofBitsTotal)) {
+    return;
+  }
+  for (uint32_t i = 0; i < nofFields; ++i) {
+    if (widths[i] != 0) {
+      writeIntern(fields[i], widths[i]);
+    }
+  }
+}
 
-  for (const uint8_t& toWrite : toAppend) {
-    write(toWrite, 8u);
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::writeExpGolomb(uint32_t value, uint32_t k) {
+  uint64_t codeNum = k <= 31u ? uint64_t{value} + (uint64_t{1} << k) : 0u;
+  uint32_t nofCodeBits = 64u - impl::countLeadingZeros64(codeNum);
+  if (k > 31u || nofCodeBits > 32u) {
+    writeError(EBitError::invalidCode, "Value too large for Exp-Golomb code.");
+    return;
   }
 
-  seek(static_cast<int32_t>(writePosBeforeBits), ilo::EPosType::begin);
+  // leading zeros are implicitly written as the most significant bits of codeNum
+  uint32_t nofBitsTotal = 2u * nofCodeBits - 1u - k;
+  if (canWrite(nofBitsTotal)) {
+    writeIntern(BitOrderT::sequenceBits(codeNum, nofBitsTotal), nofBitsTotal);
+  }
 }
 
-void CBitBuffer::erase(uint32_t firstBit, uint32_t nnofBits) {
-  uint32_t writePosBeforeBit = tell();
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::writeSignedExpGolomb(int32_t value) {
+  int64_t codeNum = value > 0 ? 2 * int64_t{value} - 1 : -2 * int64_t{value};
+  if (codeNum > 0xFFFFFFFE) {
+    writeError(EBitError::invalidCode, "Value too large for Exp-Golomb code.");
+    return;
+  }
+  writeExpGolomb(static_cast<uint32_t>(codeNum), 0);
+}
 
-  uint32_t lastBit = firstBit + nnofBits;
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::writeUnary(uint32_t value) {
+  if (PosT{value} + 1u < PosT{value}) {
+    writeError(EBitError::invalidNofBits, "Unary code exceeds the addressable bit range.");
+    return;
+  }
+  if (!canWrite(PosT{value} + 1u)) {
+    return;
+  }
+  while (value >= kMaxAccumulateBits) {
+    writeIntern(~uint64_t{0}, kMaxAccumulateBits);
+    value -= kMaxAccumulateBits;
+  }
+  writeIntern(BitOrderT::sequenceBits(((uint64_t{1} << value) - 1u) << 1u, value + 1u), value + 1u);
+}
 
-  // basic error handling:
-  ILO_ASSERT_WITH(lastBit <= nofBits(), EraseException, "The range to be erased is invalid.");
+template <typename PosT, typename BitOrderT>
+typename CBasicBitBuffer<PosT, BitOrderT>::SReservedField
+CBasicBitBuffer<PosT, BitOrderT>::reserveField(uint32_t nnofBits) {
+  SReservedField field = {tell(), 0u};
+  if (nnofBits > 64u) {
+    writeFailed(nnofBits, 64u);
+    return field;
+  }
+  if (nnofBits != 0 && canWrite(nnofBits)) {
+    writeIntern(0u, nnofBits);
+    field.nofBits = nnofBits;
+  }
+  return field;
+}
 
-  CBitParser parser(m_buffer, nofBits());
-  parser.seek(static_cast<int32_t>(lastBit), ilo::EPosType::begin);
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::patch(const SReservedField& field, uint64_t value) {
+  if (field.nofBits > 64u || field.position > nofBits() ||
+      nofBits() - field.position < field.nofBits) {
+    writeError(EBitError::invalidPosition, "Patched field is out of range.");
+    return;
+  }
+  if (field.nofBits < 64u && (value >> field.nofBits) != 0) {
+    writeError(EBitError::invalidNofBits, "Value does not fit into the patched field.");
+    return;
+  }
+  if (field.nofBits == 0) {
+    return;
+  }
 
-  uint32_t toReadBits = nofBits() - lastBit;
+  // the field may still be pending in the accumulator
+  flush();
+  uint64_t bitPos = field.position;
+  uint32_t nnofBits = field.nofBits;
+  if (nnofBits > kMaxAccumulateBits) {
+    // split into two fields in stream order
+    uint32_t firstNofBits = nnofBits - kMaxAccumulateBits;
+    uint64_t first = BitOrderT::kMsbFirst ? value >> kMaxAccumulateBits
+                                          : value & (~uint64_t{0} >> (64u - firstNofBits));
+    pokeBits<BitOrderT>(m_buffer, nofBytes(), bitPos, firstNofBits, first);
+    value = BitOrderT::kMsbFirst ? value & 0xFFFFFFFFu : value >> firstNofBits;
+    bitPos += firstNofBits;
+    nnofBits = kMaxAccumulateBits;
+  }
+  pokeBits<BitOrderT>(m_buffer, nofBytes(), bitPos, nnofBits, value);
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::append(const ilo::ByteBuffer& toAppend) {
+  appendBits(toAppend.data(), 0u, toAppend.size() * 8u);
+}
 
-  // extract all bits after last item:
-  CBitBuffer tmpBuffer;
-  uint8_t reader;
-  while (toReadBits > 0) {
-    uint32_t localToReadBit = std::min(8u, toReadBits);
-    reader = parser.read<uint8_t>(localToReadBit);
-    tmpBuffer.write(reader, localToReadBit);
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::appendBits(const uint8_t* src, size_t srcBitOffset,
+                                                  size_t nBits) {
+  if (m_useExtBuffer && (m_extBufferSizeBytes * 8u) - nofBits() < nBits) {
+    failWith<AppendException>(
+        m_errorMode, m_error, EBitError::bufferTooSmall,
+        "External Buffer size is not big enough to append the given byte buffer.");
+    return;
+  }
+  if (nBits > std::numeric_limits<PosT>::max() - nofBits()) {
+    failWith<AppendException>(m_errorMode, m_error, EBitError::invalidNofBits,
+                              "Appended data exceeds the addressable bit range.");
+    return;
+  }
+  if (nBits == 0) {
+    return;
+  }
 
-    toReadBits -= localToReadBit;
+  PosT firstBit = nofBits();
+  PosT endBits = firstBit + static_cast<PosT>(nBits);
+  PosT writePosBeforeBits = tell();
+  if (writePosBeforeBits == firstBit) {
+    writePosBeforeBits = endBits;
   }
-  // resize the buffer to truncate the data behind position
-  resize(firstBit);  // first shall not be included in remaining buffer
 
-  // add the new data at end:
-  seek(0, ilo::EPosType::end);
+  flush();
+  growTo(endBits);
+  m_nofvalidBits = endBits;
+  src += srcBitOffset >> 3u;
+  uint64_t srcBit = srcBitOffset & 0x07u;
+  copyBits<BitOrderT>(m_buffer, nofBytes(), firstBit, src,
+                      static_cast<size_t>((srcBit + nBits + 7u) >> 3u), srcBit, nBits);
+
+  seek(static_cast<OffsetType>(writePosBeforeBits), ilo::EPosType::begin);
+}
 
-  // append the extracted old data:
-  CBitParser tmpParser(tmpBuffer.bufferPtr(), tmpBuffer.nofBits());
-  toReadBits = tmpBuffer.tell();
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::erase(PosT firstBit, PosT nnofBits) {
+  PosT writePosBeforeBit = tell();
 
-  while (toReadBits > 0) {
-    uint32_t localToReadBit = std::min(8u, toReadBits);
-    reader = tmpParser.read<uint8_t>(localToReadBit);
-    write(reader, localToReadBit);
+  PosT lastBit = firstBit + nnofBits;
 
-    toReadBits -= localToReadBit;
+  // basic error handling:
+  if (lastBit > nofBits()) {
+    failWith<EraseException>(m_errorMode, m_error, EBitError::invalidPosition,
+                             "The range to be erased is invalid.");
+    return;
   }
 
+  // move the bits behind the range to its start and truncate the buffer
+  flush();
+  moveBits<BitOrderT>(m_buffer, nofBytes(), firstBit, lastBit, nofBits() - lastBit);
+  resize(nofBits() - nnofBits);
+
   if (writePosBeforeBit < firstBit) {
-    seek(static_cast<int32_t>(writePosBeforeBit), ilo::EPosType::begin);
+    seek(static_cast<OffsetType>(writePosBeforeBit), ilo::EPosType::begin);
   } else if (writePosBeforeBit >= lastBit) {
-    seek(static_cast<int32_t>(writePosBeforeBit - nnofBits), ilo::EPosType::begin);
+    seek(static_cast<OffsetType>(writePosBeforeBit - nnofBits), ilo::EPosType::begin);
   } else {
-    seek(static_cast<int32_t>(firstBit), ilo::EPosType::begin);
+    seek(static_cast<OffsetType>(firstBit), ilo::EPosType::begin);
   }
 }
 
-void CBitBuffer::resize(uint32_t newSizeInBits) {
-  uint32_t writeIterPos = tell();
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::openGap(PosT position, PosT nnofBits) {
+  PosT oldNofBits = nofBits();
+  PosT oldSizeBytes = m_sizeBytes;
+  resize(oldNofBits + nnofBits);
+  if (position == oldNofBits) {
+    // appending keeps the size of the internal buffer like a write
+    m_sizeBytes = std::max(m_sizeBytes, oldSizeBytes);
+  }
+  flush();
+  moveBits<BitOrderT>(m_buffer, nofBytes(), position + nnofBits, position, oldNofBits - position);
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::resize(PosT newSizeInBits) {
+  PosT writeIterPos = tell();
+  flushAccumulator();
+  resetAccumulator(writeIterPos);
   if (newSizeInBits > nofBits()) {
+    if (m_useExtBuffer && m_extBufferSizeBytes * 8u < newSizeInBits) {
+      failWith<std::runtime_error>(m_errorMode, m_error, EBitError::bufferTooSmall,
+                                   "New size exceeded external buffer size");
+      return;
+    }
+
     // seek to end with write pointer
     seek(0, ilo::EPosType::end);
 
-    if (m_useExtBuffer) {
-      ILO_ASSERT(m_extBufferSizeBytes * 8u >= newSizeInBits,
-                 "New size exceeded external buffer size");
-    } else {
-      m_internalBuffer.resize((newSizeInBits + 7u) / 8u);
-      m_buffer = m_internalBuffer.data();
+    if (!m_useExtBuffer) {
+      growTo(newSizeInBits);
+      m_sizeBytes = (newSizeInBits + 7u) / 8u;
     }
 
     // calculate number of bits to add
-    uint32_t nnofBitsToAdd = newSizeInBits - nofBits();
-    // add bits in bytewise manner
+    PosT nnofBitsToAdd = newSizeInBits - nofBits();
+    // add bits in 32 bit steps
     while (nnofBitsToAdd > 0) {
-      // we can add maximum 8 bits at a time
-      uint32_t bitsForNow = std::min(8u, nnofBitsToAdd);
+      uint32_t bitsForNow = static_cast<uint32_t>(std::min<PosT>(32u, nnofBitsToAdd));
       // add zeros
-      write(static_cast<uint8_t>(0), bitsForNow);
+      write(uint32_t{0}, bitsForNow);
 
       // subtract added bits:
       nnofBitsToAdd -= bitsForNow;
     }
   } else if (newSizeInBits < nofBits()) {
-    uint32_t newIter = newSizeInBits >> 3u;
-    uint32_t newSizeInBytes = (newSizeInBits + 7u) >> 3u;
+    PosT newIter = newSizeInBits >> 3u;
+    PosT newSizeInBytes = (newSizeInBits + 7u) >> 3u;
 
     if ((newSizeInBits % 8u) != 0) {
-      uint32_t overhead = 8u - newSizeInBits % 8u;
-      uint8_t mask = static_cast<uint8_t>(0xFFu << overhead);
+      uint8_t mask = BitOrderT::leadingBitsMask(static_cast<uint32_t>(newSizeInBits % 8u));
 
       m_buffer[newIter] &= mask;
       newIter++;
     }
 
-    if (m_useExtBuffer) {
-      for (size_t i = newIter; i < m_extBufferSizeBytes; i++) {
-        m_buffer[i] = 0;
-      }
-    } else if (m_internalBuffer.size() != newSizeInBytes) {
-      m_internalBuffer.resize(newSizeInBytes);
+    // the bytes behind the used size of the internal buffer are always 0
+    size_t nofBytesToClear = m_useExtBuffer ? m_extBufferSizeBytes : internalSize();
+    for (size_t i = newIter; i < nofBytesToClear; i++) {
+      m_buffer[i] = 0;
     }
+    m_sizeBytes = newSizeInBytes;
   }
 
   m_nofvalidBits = newSizeInBits;
-  seek(static_cast<int32_t>(std::min(writeIterPos, m_nofvalidBits)), EPosType::begin);
+  seek(static_cast<OffsetType>(std::min(writeIterPos, m_nofvalidBits)), EPosType::begin);
 }
 
-void CBitBuffer::seek(int32_t bitposition, ilo::EPosType fromPosition) const {
-  int32_t bitOffset = 0;
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::seek(OffsetType bitposition,
+                                            ilo::EPosType fromPosition) const {
+  OffsetType bitOffset = 0;
   // calculate absolute position:
   switch (fromPosition) {
     case ilo::EPosType::begin:
       bitOffset = bitposition;
       break;
     case ilo::EPosType::cur:
-      bitOffset = static_cast<int32_t>(m_localWriteBits) + bitposition +
-                  static_cast<int32_t>(m_writeIterBytes << 3u);
+      bitOffset = static_cast<OffsetType>(m_localWriteBits) + bitposition +
+                  static_cast<OffsetType>(m_writeIterBytes << 3u);
       break;
     case ilo::EPosType::end:
-      bitOffset = static_cast<int32_t>(nofBits()) + bitposition;
+      bitOffset = static_cast<OffsetType>(nofBits()) + bitposition;
       break;
     default:
-      ILO_ASSERT_WITH(false, SeekException, "Invalid seeking position found.");
+      failWith<SeekException>(m_errorMode, m_error, EBitError::invalidPosition,
+                              "Invalid seeking position found.");
       return;
-      break;
   }
 
   // check absolute position:
-  ILO_ASSERT_WITH(bitOffset >= 0, SeekException, "Seek to negative position.");
-  auto absoluteBitPosition = static_cast<uint32_t>(bitOffset);
-  ILO_ASSERT_WITH(absoluteBitPosition <= nofBits(), SeekException, "Seeking out of range.");
+  if (bitOffset < 0) {
+    failWith<SeekException>(m_errorMode, m_error, EBitError::invalidPosition,
+                            "Seek to negative position.");
+    return;
+  }
+  auto absoluteBitPosition = static_cast<PosT>(bitOffset);
+  if (absoluteBitPosition > nofBits()) {
+    failWith<SeekException>(m_errorMode, m_error, EBitError::invalidPosition,
+                            "Seeking out of range.");
+    return;
+  }
 
-  // set the members:
-  m_writeIterBytes = absoluteBitPosition >> 3u;
-  m_localWriteBits = absoluteBitPosition & 0x07u;
+  // store the pending bits and restart the accumulator at the new position
+  flushAccumulator();
+  resetAccumulator(absoluteBitPosition);
 }
 
-void CBitBuffer::byteAlign() {
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::byteAlign() {
   // if we are not byte aligned:
   if (m_localWriteBits % 8 != 0) {
     uint8_t zeros = 0x00;
-    uint32_t nnofBits = 8u - m_localWriteBits;
+    uint32_t nnofBits = 8u - m_localWriteBits % 8u;
     write(zeros, nnofBits);
   }
 }
 
-uint32_t CBitBuffer::nofBytes() const {
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitBuffer<PosT, BitOrderT>::nofBytes() const {
   return (m_nofvalidBits + 7u) >> 3u;
 }
 
-uint8_t* CBitBuffer::bufferPtr() {
+template <typename PosT, typename BitOrderT>
+uint8_t* CBasicBitBuffer<PosT, BitOrderT>::bufferPtr() {
+  flush();
   if (!m_useExtBuffer) {
     return m_internalBuffer.data();
   }
   return m_buffer;
 }
 
-ilo::ByteBuffer CBitBuffer::bytebuffer() const {
+template <typename PosT, typename BitOrderT>
+ilo::ByteBuffer CBasicBitBuffer<PosT, BitOrderT>::bytebuffer() const {
   ILO_ASSERT(!m_useExtBuffer, "Conversion to bytebuffer only for internal buffer.");
-  return m_internalBuffer;
+  flushAccumulator();
+  return ilo::ByteBuffer(m_internalBuffer.begin(),
+                         m_internalBuffer.begin() + static_cast<std::ptrdiff_t>(internalSize()));
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::flush() {
+  // the buffer may be modified through the returned pointers, so only bits written afterwards are
+  // kept in the accumulator
+  flushAccumulator();
+  resetAccumulator(tell());
 }
 
-uint32_t CBitBuffer::nofBits() const {
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitBuffer<PosT, BitOrderT>::nofBits() const {
   return m_nofvalidBits;
 }
 
@@ -324,84 +663,108 @@ std::ostream& operator<<(std::ostream& s, CBitBuffer bitbuffer) {
   return s;
 }
 
-uint32_t CBitBuffer::tell() const {
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitBuffer<PosT, BitOrderT>::tell() const {
   return m_writeIterBytes * 8 + m_localWriteBits;
 }
 
-void CBitBuffer::reserve(uint32_t newCapacity) {
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::reserve(PosT newCapacity) {
   // no reserve on external buffer
-  ILO_ASSERT_WITH(!m_useExtBuffer, ReserveException, "Reserve only available for internal buffer.");
-  m_internalBuffer.reserve(newCapacity);
-}
-
-void CBitBuffer::writeIntern(uint8_t toWrite, uint32_t nnofBits) {
-  // basic error handling:
-  ILO_ASSERT_WITH(nnofBits <= 8u, WriteException,
-                  "Number of bits to read larger than the given data type (8Bit).");
-
-  if (nnofBits == 0) {
+  if (m_useExtBuffer) {
+    failWith<ReserveException>(m_errorMode, m_error, EBitError::unsupported,
+                               "Reserve only available for internal buffer.");
     return;
   }
-
-  uint32_t neededMemoryBits = tell() + nnofBits;
-
-  // external buffer nothing shall be written beyond out of bounds
-  if (m_useExtBuffer) {
-    ILO_ASSERT_WITH(m_extBufferSizeBytes * 8u >= neededMemoryBits, WriteException,
-                    "External buffer size is greater than needed memory to write in.");
+  if (newCapacity > m_internalBuffer.size()) {
+    m_internalBuffer.resize(newCapacity);
+    m_buffer = m_internalBuffer.data();
   }
+}
 
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::growTo(PosT nofBitsNeeded) {
   // check capacity of buffer if we need more bytes than allocated
-  if ((!m_useExtBuffer &&
-       m_internalBuffer.size() * 8u < neededMemoryBits))  // we need to write out of buffers bounds?
-  {
-    // have to increase the size of the buffer:
-    m_internalBuffer.resize((neededMemoryBits + 7u) / 8u);  // increase size by 1
+  const uint64_t nofBytesNeeded = (static_cast<uint64_t>(nofBitsNeeded) + 7u) / 8u;
+  if (!m_useExtBuffer && m_internalBuffer.size() < nofBytesNeeded) {
+    // like a failed allocation, this cannot be latched as the caller relies on the capacity
+    const uint64_t maxSizeBytes = std::numeric_limits<size_t>::max();
+    if (nofBytesNeeded > maxSizeBytes) {
+      ILO_FAIL_WITH(std::length_error, "Buffer size exceeds the addressable memory.");
+    }
+    // grow geometrically up to the addressable size, so appending needs O(log n) reallocations
+    const uint64_t maxCapacityBytes =
+        std::min<uint64_t>(std::numeric_limits<PosT>::max() / 8u + 1u, maxSizeBytes);
+    uint64_t newCapacity =
+        std::max<uint64_t>(static_cast<uint64_t>(m_internalBuffer.size()) * 2u, kMinCapacityBytes);
+    newCapacity = std::max(std::min(newCapacity, maxCapacityBytes), nofBytesNeeded);
+    m_internalBuffer.resize(static_cast<size_t>(newCapacity));
     m_buffer = m_internalBuffer.data();
   }
+}
 
-  uint32_t shiftvalue = 16 - m_localWriteBits - nnofBits;
-
-  // create mask
-  uint16_t mask;
-  mask = static_cast<uint16_t>(0xFFu >>
-                               (8 - nnofBits));  // set the specified number of bits to one in mask
-  mask = static_cast<uint16_t>(mask << shiftvalue);  // shift to start for writing bits
-  mask = ~mask;
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::flushAccumulator() const {
+  if (m_localWriteBits <= m_accMergeBits) {
+    return;
+  }
+  // pending bits left aligned in stream order
+  uint32_t pending = BitOrderT::kMsbFirst ? static_cast<uint32_t>(m_acc << (32u - m_localWriteBits))
+                                          : static_cast<uint32_t>(m_acc);
+  uint32_t nofBytesTouched = (m_localWriteBits + 7u) / 8u;
+  for (uint32_t i = 0; i < nofBytesTouched; ++i) {
+    uint8_t byte = static_cast<uint8_t>(BitOrderT::kMsbFirst ? pending >> (24u - 8u * i)
+                                                             : pending >> (8u * i));
+    // merge the bits of the accumulator into the byte, keep the others
+    uint32_t firstBit = i == 0 ? m_accMergeBits : 0u;
+    uint32_t endBit = std::min(8u, m_localWriteBits - 8u * i);
+    uint8_t mask = static_cast<uint8_t>(BitOrderT::leadingBitsMask(endBit) &
+                                        ~BitOrderT::leadingBitsMask(firstBit));
+    uint8_t& dst = m_buffer[m_writeIterBytes + i];
+    dst = static_cast<uint8_t>((dst & ~mask) | (byte & mask));
+  }
+}
 
-  uint16_t shiftBuffer =
-      static_cast<uint16_t>(uint32_t{toWrite & (0xFFu >> (8 - nnofBits))} << shiftvalue);
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::setErrorMode(EErrorMode mode) {
+  m_errorMode = mode;
+}
 
-  // write first value:
-  m_buffer[m_writeIterBytes] = static_cast<uint8_t>(m_buffer[m_writeIterBytes] & (mask >> 8U));
-  m_buffer[m_writeIterBytes] =
-      static_cast<uint8_t>(m_buffer[m_writeIterBytes] | (shiftBuffer >> 8U));
+template <typename PosT, typename BitOrderT>
+EErrorMode CBasicBitBuffer<PosT, BitOrderT>::errorMode() const {
+  return m_errorMode;
+}
 
-  // set localWriteBits before they could be decreased:
-  m_localWriteBits += nnofBits;
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::clearError() {
+  m_error = EBitError::none;
+}
 
-  // write second value if needed:
-  if (~mask & 0xFFu) {
-    m_buffer[m_writeIterBytes + 1] =
-        static_cast<uint8_t>(m_buffer[m_writeIterBytes + 1] & (mask & 0xFFu));
-    m_buffer[m_writeIterBytes + 1] =
-        static_cast<uint8_t>(m_buffer[m_writeIterBytes + 1] | (shiftBuffer & 0xFFu));
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::writeFailed(PosT nnofBits, PosT maxNofBits) {
+  if (m_useExtBuffer && m_extBufferSizeBytes * 8u < tell() + nnofBits) {
+    failWith<WriteException>(
+        m_errorMode, m_error, EBitError::bufferTooSmall,
+        "Number of bits to write is exceeding the available size of the buffer.");
+  } else if (nnofBits > maxNofBits) {
+    failWith<WriteException>(
+        m_errorMode, m_error, EBitError::invalidNofBits,
+        "Number of bits to write is larger than the size of the value which is written.");
   }
-
-  // Should only happen if we write byte aligned
-  m_writeIterBytes += m_localWriteBits / 8;
-  m_localWriteBits %= 8;
-
-  // adjust bit counters:
-  m_nofvalidBits =
-      std::max(tell(), m_nofvalidBits);  // get maximum of current write pos and nofvalidBits
 }
 
-void CBitBuffer::iloAssertWithWriteException(bool cond, std::string msg) {
-  ILO_ASSERT_WITH(cond, WriteException, msg.c_str());
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::writeError(EBitError error, const char* msg) {
+  failWith<WriteException>(m_errorMode, m_error, error, msg);
 }
 
-void CBitBuffer::iloAssertWithInsertException(bool cond, std::string msg) {
-  ILO_ASSERT_WITH(cond, InsertException, msg.c_str());
+template <typename PosT, typename BitOrderT>
+void CBasicBitBuffer<PosT, BitOrderT>::insertFailed(EBitError error, const char* msg) {
+  failWith<InsertException>(m_errorMode, m_error, error, msg);
 }
+
+template class CBasicBitBuffer<uint32_t, SMsbFirst>;
+template class CBasicBitBuffer<uint64_t, SMsbFirst>;
+template class CBasicBitBuffer<uint32_t, SLsbFirst>;
+template class CBasicBitBuffer<uint64_t, SLsbFirst>;
 }  // namespace ilo
@@ -80,125 +80,150 @@ www.iis.fraunhofer.de/amm
 amm-info@iis.fraunhofer.de
 -----------------------------------------------------------------------------*/
 
+// System includes
+#include <algorithm>
+#include <cstring>
+
 // Internal includes
 #include "ilo/bitparser.h"
 #include "ilo_logging.h"
 
 namespace ilo {
-CBitParser::CBitParser(const ilo::ByteBuffer& externalBuffer, const uint32_t nofValidBits)
-    : m_buffer(externalBuffer.data()), m_readIter(0U), m_localReadBits(0U) {
-  m_nofValidBits = nofValidBits;
-  if (m_nofValidBits == 0) {
-    m_nofValidBits = static_cast<uint32_t>(externalBuffer.size()) * 8;
-  }
+namespace {
+template <typename PosT, typename BitOrderT>
+impl::SBitReadCache<PosT, BitOrderT> makeReadState(const uint8_t* buffer, PosT nofValidBits) {
+  impl::SBitReadCache<PosT, BitOrderT> state = {};
+  state.buffer = buffer;
+  state.nofBytes = (nofValidBits + 7u) >> 3u;
+  return state;
 }
 
-CBitParser::CBitParser(ByteBuffer::const_iterator& begin, const size_t size,
-                       const uint32_t nofValidBits)
-    : m_buffer(&begin[0]), m_readIter(0U), m_localReadBits(0U) {
-  m_nofValidBits = nofValidBits;
+//! Minimum pattern width for which findPattern can use the byte prefilter
+const uint32_t kMinAnchoredPatternBits = 15u;
+
+//! Checks whether the pattern word matches the bits at bit position pos
+template <typename BitOrderT, typename PosT>
+bool matchesAt(const uint8_t* buffer, PosT nofBytes, PosT pos, uint64_t patternWord,
+               uint64_t patternMask) {
+  PosT bytePos = pos >> 3u;
+  uint64_t word = (bytePos + 8u <= nofBytes) ? BitOrderT::loadWord(buffer + bytePos)
+                                             : BitOrderT::loadTail(buffer, nofBytes, bytePos);
+  word = BitOrderT::dropBits(word, static_cast<uint32_t>(pos & 0x07u));
+  return ((word ^ patternWord) & patternMask) == 0;
+}
+}  // namespace
+
+template <typename PosT, typename BitOrderT>
+CBasicBitParser<PosT, BitOrderT>::CBasicBitParser(const ilo::ByteBuffer& externalBuffer,
+                                                  const PosT nofValidBits)
+    : m_state(),
+      m_nofValidBits(nofValidBits),
+      m_beginPos(0),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {
   if (m_nofValidBits == 0) {
-    m_nofValidBits = static_cast<uint32_t>(size) * 8;
+    m_nofValidBits = static_cast<PosT>(externalBuffer.size()) * 8;
   }
+  m_state = makeReadState<PosT, BitOrderT>(externalBuffer.data(), m_nofValidBits);
 }
 
-CBitParser::CBitParser(ByteBuffer::const_iterator& begin, const ByteBuffer::const_iterator& end,
-                       const uint32_t nofValidBits)
-    : m_buffer(&begin[0]), m_readIter(0U), m_localReadBits(0U) {
-  m_nofValidBits = nofValidBits;
+template <typename PosT, typename BitOrderT>
+CBasicBitParser<PosT, BitOrderT>::CBasicBitParser(ByteBuffer::const_iterator& begin,
+                                                  const size_t size, const PosT nofValidBits)
+    : m_state(),
+      m_nofValidBits(nofValidBits),
+      m_beginPos(0),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {
   if (m_nofValidBits == 0) {
-    m_nofValidBits = static_cast<uint32_t>(end - begin) * 8;
+    m_nofValidBits = static_cast<PosT>(size) * 8;
   }
+  m_state = makeReadState<PosT, BitOrderT>(&begin[0], m_nofValidBits);
 }
 
-CBitParser::CBitParser(uint8_t* buffer, const uint32_t nofValidBits)
-    : m_buffer(buffer), m_readIter(0U), m_localReadBits(0U), m_nofValidBits(nofValidBits) {}
-
-CBitParser::~CBitParser() {}
-
-uint8_t CBitParser::readUint8(uint32_t nnofBits) {
-  uint8_t result = 0;
-
-  // basic error handling (nnofBits > 8)
-  ILO_ASSERT_WITH(nnofBits <= 8 && nnofBits > 0, ReadException,
-                  "Number of bits to write are not within the range of uint8_t.");
-
-  // check bounds:
-  ILO_ASSERT_WITH(m_nofValidBits >= (m_readIter << 3) + m_localReadBits + nnofBits, ReadException,
-                  "EOF reached.");
-
-  // check if we are inbetween one byte
-  if (m_localReadBits + nnofBits <= 8) {
-    // create mask
-    uint8_t mask = 0xFFu;
-    // move mask to last read pointer
-    mask = mask >> m_localReadBits;
-    // get the current buffer character:
-    result = m_buffer[m_readIter] & mask;
-    // move the essential bits to correct position:
-    result = result >> (8 - (nnofBits + m_localReadBits));
-  } else {
-    uint16_t mask = 0xFFFFu;
-    // move mask to last read bit ptr
-    mask = mask >> m_localReadBits;
-    // fill shift buffer:
-    uint16_t shiftBuffer = static_cast<uint16_t>(
-        (static_cast<uint16_t>(m_buffer[m_readIter]) << 8U) | m_buffer[m_readIter + 1]);
-    // mask out already read bits:
-    shiftBuffer = shiftBuffer & mask;
-    // move the essential bits to correct position:
-    shiftBuffer = shiftBuffer >> (16 - (nnofBits + m_localReadBits));
-    // assign to output
-    result = static_cast<uint8_t>(shiftBuffer);
-  }
-  m_localReadBits += nnofBits;
-  if (m_localReadBits > 8) {
-    m_localReadBits -= 8;
-    m_readIter++;
+template <typename PosT, typename BitOrderT>
+CBasicBitParser<PosT, BitOrderT>::CBasicBitParser(ByteBuffer::const_iterator& begin,
+                                                  const ByteBuffer::const_iterator& end,
+                                                  const PosT nofValidBits)
+    : m_state(),
+      m_nofValidBits(nofValidBits),
+      m_beginPos(0),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {
+  if (m_nofValidBits == 0) {
+    m_nofValidBits = static_cast<PosT>(end - begin) * 8;
   }
-
-  return result;
+  m_state = makeReadState<PosT, BitOrderT>(&begin[0], m_nofValidBits);
 }
 
-void CBitParser::seek(int32_t bitposition, ilo::EPosType fromPosition) {
-  int32_t bitOffset = 0;
+template <typename PosT, typename BitOrderT>
+CBasicBitParser<PosT, BitOrderT>::CBasicBitParser(uint8_t* buffer, const PosT nofValidBits)
+    : m_state(makeReadState<PosT, BitOrderT>(buffer, nofValidBits)),
+      m_nofValidBits(nofValidBits),
+      m_beginPos(0),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {}
+
+template <typename PosT, typename BitOrderT>
+CBasicBitParser<PosT, BitOrderT>::CBasicBitParser(const impl::SBitReadCache<PosT, BitOrderT>& state,
+                                                  PosT beginPos, PosT endPos, EErrorMode errorMode,
+                                                  EBitError error)
+    : m_state(state),
+      m_nofValidBits(endPos),
+      m_beginPos(beginPos),
+      m_errorMode(errorMode),
+      m_error(error) {}
+
+template <typename PosT, typename BitOrderT>
+CBasicBitParser<PosT, BitOrderT>::~CBasicBitParser() {}
+
+template <typename PosT, typename BitOrderT>
+void CBasicBitParser<PosT, BitOrderT>::seek(OffsetType bitposition, ilo::EPosType fromPosition) {
+  OffsetType bitOffset = 0;
   // calculate absolute position:
   switch (fromPosition) {
     case ilo::EPosType::begin:
-      bitOffset = bitposition;
+      bitOffset = static_cast<OffsetType>(m_beginPos) + bitposition;
       break;
     case ilo::EPosType::cur:
-      bitOffset = static_cast<int32_t>(m_localReadBits) + bitposition +
-                  static_cast<int32_t>(m_readIter << 3);
+      bitOffset = static_cast<OffsetType>(m_state.pos) + bitposition;
       break;
     case ilo::EPosType::end:
-      bitOffset = static_cast<int32_t>(m_nofValidBits) + bitposition;
+      bitOffset = static_cast<OffsetType>(m_nofValidBits) + bitposition;
       break;
     default:
-      ILO_ASSERT_WITH(false, SeekException, "Invalid seeking position found.");
-      break;
+      seekFailed(EBitError::invalidPosition, "Invalid seeking position found.");
+      return;
   }
   // check absolute position:
-  ILO_ASSERT_WITH(bitOffset >= 0, SeekException, "Seek to negative position.");
-  auto absoluteBitPosition = static_cast<uint32_t>(bitOffset);
-  ILO_ASSERT_WITH(absoluteBitPosition <= m_nofValidBits, SeekException, "Seeking out of range.");
+  if (bitOffset < static_cast<OffsetType>(m_beginPos)) {
+    seekFailed(EBitError::invalidPosition, "Seek to negative position.");
+    return;
+  }
+  auto absoluteBitPosition = static_cast<PosT>(bitOffset);
+  if (absoluteBitPosition > m_nofValidBits) {
+    seekFailed(EBitError::invalidPosition, "Seeking out of range.");
+    return;
+  }
 
-  // set the members:
-  m_readIter = absoluteBitPosition >> 3;
-  m_localReadBits = absoluteBitPosition & 0x07;
+  // set the members and invalidate the cache register:
+  m_state.reset(absoluteBitPosition);
 }
 
-uint32_t CBitParser::nofBytes() const {
-  return (m_nofValidBits + 7) >> 3;
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitParser<PosT, BitOrderT>::nofBytes() const {
+  return (nofBits() + 7u) >> 3u;
 }
 
-const uint8_t* CBitParser::internalBufferPtr() {
-  return m_buffer;
+template <typename PosT, typename BitOrderT>
+const uint8_t* CBasicBitParser<PosT, BitOrderT>::internalBufferPtr() {
+  return m_state.buffer;
 }
 
 // get the nuber of bits in the buffer (not byte aligned)
-uint32_t CBitParser::nofBits() const {
-  return m_nofValidBits;
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitParser<PosT, BitOrderT>::nofBits() const {
+  return m_nofValidBits - m_beginPos;
 }
 
 // function to print out the whole bitbuffer bit-by-bit (for debugging)
@@ -215,30 +240,247 @@ std::ostream& operator<<(std::ostream& s, CBitParser bitparser) {
 }
 
 // function to get eof indication:
-bool CBitParser::eof() const {
-  return nofReadBits() >= m_nofValidBits;
+template <typename PosT, typename BitOrderT>
+bool CBasicBitParser<PosT, BitOrderT>::eof() const {
+  return m_state.pos >= m_nofValidBits;
 }
 
 // function to get position of reader
-uint32_t CBitParser::tell() const {
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitParser<PosT, BitOrderT>::tell() const {
   return nofReadBits();
 }
 
 // function to get number of read bits
-uint32_t CBitParser::nofReadBits() const {
-  return (m_readIter << 3) + m_localReadBits;
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitParser<PosT, BitOrderT>::nofReadBits() const {
+  return m_state.pos - m_beginPos;
 }
 
-uint32_t CBitParser::nofBitsLeft() const {
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitParser<PosT, BitOrderT>::nofBitsLeft() const {
   return nofBits() - nofReadBits();
 }
 
-void CBitParser::iloAssertWithReadException(bool cond, std::string msg) {
-  ILO_ASSERT_WITH(cond, ReadException, msg.c_str());
+template <typename PosT, typename BitOrderT>
+void CBasicBitParser<PosT, BitOrderT>::setErrorMode(EErrorMode mode) {
+  m_errorMode = mode;
+}
+
+template <typename PosT, typename BitOrderT>
+EErrorMode CBasicBitParser<PosT, BitOrderT>::errorMode() const {
+  return m_errorMode;
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicBitParser<PosT, BitOrderT>::clearError() {
+  m_error = EBitError::none;
 }
 
-void CBitParser::iloAssertWithSeekException(bool cond, std::string msg) {
-  ILO_ASSERT_WITH(cond, SeekException, msg.c_str());
+template <typename PosT, typename BitOrderT>
+void CBasicBitParser<PosT, BitOrderT>::readBytes(uint8_t* dst, size_t nofBytes) {
+  if (nofBytes > nofBitsLeft() / 8u) {
+    readError(EBitError::endOfData, "Not enough data left to parse.");
+    return;
+  }
+  if (nofBytes == 0) {
+    return;
+  }
+
+  const uint8_t* src = m_state.buffer + (m_state.pos >> 3u);
+  uint32_t shift = static_cast<uint32_t>(m_state.pos & 0x07u);
+  if (shift == 0) {
+    std::memcpy(dst, src, nofBytes);
+  } else {
+    // the bits are spread over nofBytes + 1 source bytes, which are all inside the buffer
+    size_t i = 0;
+    for (; i + 8u <= nofBytes; i += 8u) {
+      uint64_t word = BitOrderT::funnel(BitOrderT::loadWord(src + i),
+                                        BitOrderT::byteWord(src[i + 8u]), shift);
+      BitOrderT::storeWord(dst + i, word);
+    }
+    for (; i < nofBytes; ++i) {
+      uint64_t word = BitOrderT::dropBits(BitOrderT::loadTail(src + i, 2u, 0u), shift);
+      dst[i] = static_cast<uint8_t>(BitOrderT::firstBits(word, 8u));
+    }
+  }
+  m_state.reset(m_state.pos + static_cast<PosT>(nofBytes) * 8u);
+}
+
+template <typename PosT, typename BitOrderT>
+SBytesView CBasicBitParser<PosT, BitOrderT>::bytesView(size_t nofBytes, ByteBuffer& scratch) {
+  if (nofBytes > nofBitsLeft() / 8u) {
+    readError(EBitError::endOfData, "Not enough data left to parse.");
+    return SBytesView{nullptr, 0};
+  }
+  if ((m_state.pos & 0x07u) == 0) {
+    SBytesView view{m_state.buffer + (m_state.pos >> 3u), nofBytes};
+    m_state.reset(m_state.pos + static_cast<PosT>(nofBytes) * 8u);
+    return view;
+  }
+  scratch.resize(nofBytes);
+  readBytes(scratch.data(), nofBytes);
+  return SBytesView{scratch.data(), nofBytes};
+}
+
+template <typename PosT, typename BitOrderT>
+PosT CBasicBitParser<PosT, BitOrderT>::findPattern(uint64_t pattern, uint32_t nnofBits,
+                                                  PosT fromBit) {
+  if (nnofBits == 0 || nnofBits > impl::SBitReadCache<PosT, BitOrderT>::kMaxReadBits) {
+    readError(EBitError::invalidNofBits, "Pattern width must be 1 to 57 bits.");
+    return nofBits();
+  }
+  if (fromBit > nofBits() || nofBits() - fromBit < nnofBits) {
+    return nofBits();
+  }
+  // the pattern placed at the first bits of a word
+  uint32_t patternShift = BitOrderT::fieldShift(0u, nnofBits);
+  uint64_t patternMask = lowBitMask(nnofBits) << patternShift;
+  uint64_t patternWord = (pattern << patternShift) & patternMask;
+
+  const uint8_t* buffer = m_state.buffer;
+  PosT nofBytes = m_state.nofBytes;
+  PosT firstPos = m_beginPos + fromBit;
+  PosT lastPos = m_nofValidBits - nnofBits;
+
+  if (nnofBits >= kMinAnchoredPatternBits) {
+    // Each match covers a whole byte, whose value only depends on the bit offset of the match.
+    // Only the bytes with one of these 8 values are candidates for a match.
+    uint8_t anchorOffsets[256] = {};
+    for (uint32_t offset = 0; offset < 8u; ++offset) {
+      uint32_t anchorBit = (8u - offset) & 0x07u;
+      anchorOffsets[BitOrderT::extractField(pattern, nnofBits, anchorBit, 8u)] |= 1u << offset;
+    }
+    // bit i of the candidates stands for the match start anchorPos * 8 - 7 + i
+    PosT anchorEnd = std::min<PosT>((lastPos + 7u) >> 3u, nofBytes - 1u) + 1u;
+    for (PosT anchorPos = (firstPos + 7u) >> 3u; anchorPos < anchorEnd; ++anchorPos) {
+      uint32_t offsets = anchorOffsets[buffer[anchorPos]];
+      if (offsets == 0) {
+        continue;
+      }
+      uint32_t candidates = (offsets >> 1u) | ((offsets & 1u) << 7u);
+      while (candidates != 0) {
+        PosT startPlus7 = anchorPos * 8u + impl::countTrailingZeros64(candidates);
+        candidates &= candidates - 1u;
+        if (startPlus7 < firstPos + 7u || startPlus7 > lastPos + 7u) {
+          continue;
+        }
+        PosT matchPos = startPlus7 - 7u;
+        if (matchesAt<BitOrderT>(buffer, nofBytes, matchPos, patternWord, patternMask)) {
+          return matchPos - m_beginPos;
+        }
+      }
+    }
+    return nofBits();
+  }
+
+  // short patterns: test each byte at all 8 offsets
+  PosT lastByte = lastPos >> 3u;
+  uint32_t validOffsets = 0xFFu << (firstPos & 0x07u);
+  for (PosT bytePos = firstPos >> 3u; bytePos <= lastByte; ++bytePos) {
+    uint64_t word = (bytePos + 8u <= nofBytes) ? BitOrderT::loadWord(buffer + bytePos)
+                                               : BitOrderT::loadTail(buffer, nofBytes, bytePos);
+    // one bit per offset, all 8 comparisons are independent
+    uint32_t matches = 0;
+    for (uint32_t offset = 0; offset < 8u; ++offset) {
+      uint64_t diff = (BitOrderT::dropBits(word, offset) ^ patternWord) & patternMask;
+      matches |= static_cast<uint32_t>(diff == 0) << offset;
+    }
+    matches &= validOffsets;
+    if (bytePos == lastByte) {
+      matches &= 0xFFu >> (7u - (lastPos & 0x07u));
+    }
+    if (matches != 0) {
+      return bytePos * 8u + impl::countTrailingZeros64(matches) - m_beginPos;
+    }
+    validOffsets = 0xFFu;
+  }
+  return nofBits();
+}
+
+template <typename PosT, typename BitOrderT>
+uint64_t CBasicBitParser<PosT, BitOrderT>::readFailed(PosT nnofBits, PosT maxNofBits) {
+  bool endOfData = nnofBits > nofBitsLeft();
+  if (m_errorMode == EErrorMode::latch) {
+    if (m_error == EBitError::none) {
+      m_error = endOfData ? EBitError::endOfData : EBitError::invalidNofBits;
+    }
+    return 0;
+  }
+
+  ILO_ASSERT_WITH(!endOfData, ReadException, "Not enough data left to parse.");
+  ILO_ASSERT_WITH(nnofBits <= maxNofBits, ReadException,
+                  "Number of bits does not fit into the given variable");
+  return 0;
+}
+
+template <typename PosT, typename BitOrderT>
+uint64_t CBasicBitParser<PosT, BitOrderT>::readError(EBitError error, const char* msg) {
+  if (m_errorMode == EErrorMode::latch) {
+    if (m_error == EBitError::none) {
+      m_error = error;
+    }
+    return 0;
+  }
+  ILO_FAIL_WITH(ReadException, "%s", msg);
+}
+
+template <typename PosT, typename BitOrderT>
+uint64_t CBasicBitParser<PosT, BitOrderT>::expGolombFailed(uint32_t leadingZeros, uint32_t k) {
+  if (leadingZeros + k <= 31u || leadingZeros >= nofBitsLeft()) {
+    return readError(EBitError::endOfData, "Not enough data left to parse.");
+  }
+  return readError(EBitError::invalidCode, "Exp-Golomb code exceeds 32 bits.");
+}
+
+template <typename PosT, typename BitOrderT>
+uint64_t CBasicBitParser<PosT, BitOrderT>::vlcFailed(uint32_t nofCodeBits, uint32_t maxCodeBits) {
+  // the lookup works on zero padded bits behind the end of the data
+  if (nofCodeBits > nofBitsLeft() || (nofCodeBits == 0 && maxCodeBits > nofBitsLeft())) {
+    return readError(EBitError::endOfData, "Not enough data left to parse.");
+  }
+  return readError(EBitError::invalidCode, "Invalid variable length codeword.");
+}
+
+template <typename PosT, typename BitOrderT>
+uint64_t CBasicBitParser<PosT, BitOrderT>::readEscapedValueSlow(uint32_t nBits1,
+                                                                uint32_t nBits2,
+                                                                uint32_t nBits3) {
+  if (nBits1 > 32u || nBits2 > 32u || nBits3 > 32u) {
+    return readError(EBitError::invalidNofBits, "Fields of escapedValue() exceed 32 bits.");
+  }
+
+  PosT startPos = m_state.pos;
+  uint32_t widths[3] = {nBits1, nBits2, nBits3};
+  uint64_t result = 0;
+  for (uint32_t i = 0; i < 3u; ++i) {
+    if (widths[i] > m_nofValidBits - m_state.pos) {
+      // nothing shall be consumed on failure
+      m_state.reset(startPos);
+      return readError(EBitError::endOfData, "Not enough data left to parse.");
+    }
+    uint64_t field = widths[i] == 0 ? 0u : m_state.readAny(widths[i]);
+    result += field;
+    if (field != lowBitMask(widths[i])) {
+      break;
+    }
+  }
+  return result;
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicBitParser<PosT, BitOrderT>::seekFailed(EBitError error, const char* msg) {
+  if (m_errorMode == EErrorMode::latch) {
+    if (m_error == EBitError::none) {
+      m_error = error;
+    }
+    return;
+  }
+  ILO_FAIL_WITH(SeekException, "%s", msg);
 }
 
+template class CBasicBitParser<uint32_t, SMsbFirst>;
+template class CBasicBitParser<uint64_t, SMsbFirst>;
+template class CBasicBitParser<uint32_t, SLsbFirst>;
+template class CBasicBitParser<uint64_t, SLsbFirst>;
 }  // namespace ilo
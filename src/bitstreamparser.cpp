@@ -0,0 +1,255 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+// System includes
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Internal includes
+#include "ilo/bitstreamparser.h"
+#include "ilo_logging.h"
+
+namespace ilo {
+CBitStreamParser::CBitStreamParser() : CBitStreamParser(RefillCallback()) {}
+
+CBitStreamParser::CBitStreamParser(RefillCallback refillCallback)
+    : m_refillCallback(std::move(refillCallback)),
+      m_chunks(),
+      m_chunkData(nullptr),
+      m_chunkSize(0),
+      m_chunkPos(0),
+      m_nofQueuedBytes(0),
+      m_cache(0),
+      m_cacheBits(0),
+      m_pos(0),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {}
+
+void CBitStreamParser::pushChunk(ByteBuffer&& chunk) {
+  if (chunk.empty()) {
+    return;
+  }
+  m_nofQueuedBytes += chunk.size();
+  // moving the vector into the deque keeps its data pointer valid
+  m_chunks.push_back(std::move(chunk));
+  if (m_chunks.size() == 1u) {
+    m_chunkData = m_chunks.front().data();
+    m_chunkSize = m_chunks.front().size();
+    m_chunkPos = 0;
+  }
+}
+
+void CBitStreamParser::pushChunk(const uint8_t* data, size_t size) {
+  pushChunk(ByteBuffer(data, data + size));
+}
+
+void CBitStreamParser::skip(uint64_t nofBits) {
+  if (nofBits <= m_cacheBits) {
+    m_cache = nofBits < 64u ? m_cache << nofBits : 0u;
+    m_cacheBits -= static_cast<uint32_t>(nofBits);
+    m_pos += nofBits;
+    return;
+  }
+
+  // drop the cache register and step over whole bytes in the chunks
+  uint64_t nofBitsLeft = nofBits - m_cacheBits;
+  m_pos += m_cacheBits;
+  m_cache = 0;
+  m_cacheBits = 0;
+  while (nofBitsLeft >= 8u) {
+    if (!nextChunk()) {
+      readError(EBitError::endOfData, "Not enough data left to skip.");
+      return;
+    }
+    uint64_t nofBytes = std::min<uint64_t>(m_chunkSize - m_chunkPos, nofBitsLeft / 8u);
+    m_chunkPos += static_cast<size_t>(nofBytes);
+    m_nofQueuedBytes -= nofBytes;
+    m_pos += nofBytes * 8u;
+    nofBitsLeft -= nofBytes * 8u;
+  }
+  if (nofBitsLeft != 0) {
+    if (!fetch(nofBitsLeft)) {
+      readError(EBitError::endOfData, "Not enough data left to skip.");
+      return;
+    }
+    take(static_cast<uint32_t>(nofBitsLeft));
+  }
+}
+
+void CBitStreamParser::readBytes(uint8_t* dst, size_t nofBytes) {
+  if ((m_cacheBits & 0x07u) != 0) {
+    for (; nofBytes != 0; --nofBytes) {
+      if (m_cacheBits < 8u && !fetch(8u)) {
+        readError(EBitError::endOfData, "Not enough data left to parse.");
+        return;
+      }
+      *dst++ = static_cast<uint8_t>(take(8u));
+    }
+    return;
+  }
+
+  // byte aligned: empty the cache register, then copy straight from the chunks
+  for (; nofBytes != 0 && m_cacheBits != 0; --nofBytes) {
+    *dst++ = static_cast<uint8_t>(take(8u));
+  }
+  while (nofBytes != 0) {
+    if (!nextChunk()) {
+      readError(EBitError::endOfData, "Not enough data left to parse.");
+      return;
+    }
+    size_t nofCopyBytes = std::min(m_chunkSize - m_chunkPos, nofBytes);
+    std::memcpy(dst, m_chunkData + m_chunkPos, nofCopyBytes);
+    m_chunkPos += nofCopyBytes;
+    m_nofQueuedBytes -= nofCopyBytes;
+    m_pos += uint64_t{nofCopyBytes} * 8u;
+    dst += nofCopyBytes;
+    nofBytes -= nofCopyBytes;
+  }
+}
+
+bool CBitStreamParser::fetch(uint64_t nofBits) {
+  while (nofBitsAvailable() < nofBits && m_refillCallback) {
+    ByteBuffer chunk;
+    if (!m_refillCallback(chunk)) {
+      break;
+    }
+    pushChunk(std::move(chunk));
+  }
+  if (m_cacheBits <= 56u) {
+    refill();
+  }
+  return nofBitsAvailable() >= nofBits;
+}
+
+void CBitStreamParser::refillSlow() {
+  while (m_cacheBits <= 56u) {
+    if (m_chunkPos == m_chunkSize) {
+      if (m_chunks.empty()) {
+        return;
+      }
+      popChunk();
+      continue;
+    }
+    if (m_chunkPos + 8u <= m_chunkSize) {
+      refill();
+      return;
+    }
+    m_cache |= uint64_t{m_chunkData[m_chunkPos++]} << (56u - m_cacheBits);
+    m_cacheBits += 8u;
+    m_nofQueuedBytes -= 1u;
+  }
+}
+
+void CBitStreamParser::popChunk() {
+  m_chunks.pop_front();
+  m_chunkData = m_chunks.empty() ? nullptr : m_chunks.front().data();
+  m_chunkSize = m_chunks.empty() ? 0u : m_chunks.front().size();
+  m_chunkPos = 0;
+}
+
+bool CBitStreamParser::nextChunk() {
+  while (m_chunkPos == m_chunkSize) {
+    if (!m_chunks.empty()) {
+      popChunk();
+      continue;
+    }
+    ByteBuffer chunk;
+    if (!m_refillCallback || !m_refillCallback(chunk)) {
+      return false;
+    }
+    pushChunk(std::move(chunk));
+  }
+  return true;
+}
+
+uint64_t CBitStreamParser::readError(EBitError error, const char* msg) {
+  if (m_errorMode == EErrorMode::latch) {
+    if (m_error == EBitError::none) {
+      m_error = error;
+    }
+    return 0;
+  }
+  ILO_FAIL_WITH(ReadException, "%s", msg);
+}
+}  // namespace ilo
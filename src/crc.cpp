@@ -0,0 +1,324 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+// System includes
+#include <stdexcept>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+// Internal includes
+#include "ilo/crc.h"
+#include "ilo/bittool_utils.h"
+#include "ilo_logging.h"
+
+namespace ilo {
+namespace impl {
+struct SCrcTables {
+  //! table[k][b]: register update for byte b followed by k zero bytes
+  uint32_t table[8][256];
+};
+}  // namespace impl
+
+namespace {
+SCrcParams paramsOf(ECrcType type) {
+  switch (type) {
+    case ECrcType::crc16:
+      return SCrcParams{16u, 0x8005u, 0xFFFFu, false, 0u};
+    case ECrcType::crc32Mpeg2:
+      return SCrcParams{32u, 0x04C11DB7u, 0xFFFFFFFFu, false, 0u};
+    case ECrcType::crc32:
+      return SCrcParams{32u, 0x04C11DB7u, 0xFFFFFFFFu, true, 0xFFFFFFFFu};
+    case ECrcType::crc32c:
+      return SCrcParams{32u, 0x1EDC6F41u, 0xFFFFFFFFu, true, 0xFFFFFFFFu};
+  }
+  throw std::invalid_argument("Unknown CRC type.");
+}
+
+//! Reverses the order of the nofBits (1 to 32) least significant bits of value
+uint32_t reflect(uint32_t value, uint32_t nofBits) {
+  return static_cast<uint32_t>(impl::reverseBits64(value) >> (64u - nofBits));
+}
+
+std::shared_ptr<const impl::SCrcTables> createTables(const SCrcParams& params) {
+  std::shared_ptr<impl::SCrcTables> tables = std::make_shared<impl::SCrcTables>();
+  if (params.reflected) {
+    uint32_t polynomial = reflect(params.polynomial, params.nofBits);
+    for (uint32_t b = 0; b < 256u; ++b) {
+      uint32_t reg = b;
+      for (uint32_t i = 0; i < 8u; ++i) {
+        reg = (reg & 1u) ? (reg >> 1u) ^ polynomial : reg >> 1u;
+      }
+      tables->table[0][b] = reg;
+    }
+    for (uint32_t k = 1; k < 8u; ++k) {
+      for (uint32_t b = 0; b < 256u; ++b) {
+        uint32_t prev = tables->table[k - 1][b];
+        tables->table[k][b] = (prev >> 8u) ^ tables->table[0][prev & 0xFFu];
+      }
+    }
+  } else {
+    uint32_t polynomial = params.polynomial << (32u - params.nofBits);
+    for (uint32_t b = 0; b < 256u; ++b) {
+      uint32_t reg = b << 24u;
+      for (uint32_t i = 0; i < 8u; ++i) {
+        reg = (reg & 0x80000000u) ? (reg << 1u) ^ polynomial : reg << 1u;
+      }
+      tables->table[0][b] = reg;
+    }
+    for (uint32_t k = 1; k < 8u; ++k) {
+      for (uint32_t b = 0; b < 256u; ++b) {
+        uint32_t prev = tables->table[k - 1][b];
+        tables->table[k][b] = (prev << 8u) ^ tables->table[0][prev >> 24u];
+      }
+    }
+  }
+  return tables;
+}
+
+std::shared_ptr<const impl::SCrcTables> sharedTables(ECrcType type) {
+  static const std::shared_ptr<const impl::SCrcTables> crc16 =
+      createTables(paramsOf(ECrcType::crc16));
+  static const std::shared_ptr<const impl::SCrcTables> crc32Mpeg2 =
+      createTables(paramsOf(ECrcType::crc32Mpeg2));
+  static const std::shared_ptr<const impl::SCrcTables> crc32 =
+      createTables(paramsOf(ECrcType::crc32));
+  static const std::shared_ptr<const impl::SCrcTables> crc32c =
+      createTables(paramsOf(ECrcType::crc32c));
+  switch (type) {
+    case ECrcType::crc16:
+      return crc16;
+    case ECrcType::crc32Mpeg2:
+      return crc32Mpeg2;
+    case ECrcType::crc32:
+      return crc32;
+    case ECrcType::crc32c:
+      return crc32c;
+  }
+  throw std::invalid_argument("Unknown CRC type.");
+}
+}  // namespace
+
+CCrc::CCrc(ECrcType type) : m_params(paramsOf(type)), m_tables(sharedTables(type)) {
+  init();
+}
+
+CCrc::CCrc(const SCrcParams& params) : m_params(params) {
+  ILO_ASSERT_WITH(params.nofBits >= 1u && params.nofBits <= 32u, std::invalid_argument,
+                  "CRC width must be 1 to 32 bits.");
+  uint32_t unusedMask = params.nofBits == 32u ? 0u : ~0u << params.nofBits;
+  ILO_ASSERT_WITH(((params.polynomial | params.init | params.xorOut) & unusedMask) == 0,
+                  std::invalid_argument, "CRC parameters exceed the width of the CRC.");
+  m_tables = createTables(params);
+  init();
+}
+
+void CCrc::init() {
+  m_engine = EEngine::table;
+  if (m_params.nofBits == 32u && m_params.reflected) {
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    if (m_params.polynomial == 0x1EDC6F41u) {
+      m_engine = EEngine::crc32cInstruction;
+    }
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+    if (m_params.polynomial == 0x04C11DB7u) {
+      m_engine = EEngine::crc32Instruction;
+    }
+#endif
+  }
+  m_initRegister = m_params.reflected ? reflect(m_params.init, m_params.nofBits)
+                                      : m_params.init << (32u - m_params.nofBits);
+  m_register = m_initRegister;
+}
+
+void CCrc::reset() {
+  m_register = m_initRegister;
+}
+
+void CCrc::update(const uint8_t* data, size_t size) {
+  switch (m_engine) {
+#if defined(__SSE4_2__)
+    case EEngine::crc32cInstruction: {
+      uint64_t reg = m_register;
+      for (; size >= 8u; data += 8u, size -= 8u) {
+        reg = _mm_crc32_u64(reg, impl::loadLE64(data));
+      }
+      m_register = static_cast<uint32_t>(reg);
+      for (; size != 0; ++data, --size) {
+        m_register = _mm_crc32_u8(m_register, *data);
+      }
+      return;
+    }
+#elif defined(__ARM_FEATURE_CRC32)
+    case EEngine::crc32cInstruction:
+      for (; size >= 8u; data += 8u, size -= 8u) {
+        m_register = __crc32cd(m_register, impl::loadLE64(data));
+      }
+      for (; size != 0; ++data, --size) {
+        m_register = __crc32cb(m_register, *data);
+      }
+      return;
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+    case EEngine::crc32Instruction:
+      for (; size >= 8u; data += 8u, size -= 8u) {
+        m_register = __crc32d(m_register, impl::loadLE64(data));
+      }
+      for (; size != 0; ++data, --size) {
+        m_register = __crc32b(m_register, *data);
+      }
+      return;
+#endif
+    default:
+      updateTable(data, size);
+      return;
+  }
+}
+
+void CCrc::updateTable(const uint8_t* data, size_t size) {
+  const uint32_t(*t)[256] = m_tables->table;
+  uint32_t reg = m_register;
+  if (m_params.reflected) {
+    for (; size >= 8u; data += 8u, size -= 8u) {
+      uint64_t word = impl::loadLE64(data);
+      uint32_t low = reg ^ static_cast<uint32_t>(word);
+      uint32_t high = static_cast<uint32_t>(word >> 32u);
+      reg = t[7][low & 0xFFu] ^ t[6][(low >> 8u) & 0xFFu] ^ t[5][(low >> 16u) & 0xFFu] ^
+            t[4][low >> 24u] ^ t[3][high & 0xFFu] ^ t[2][(high >> 8u) & 0xFFu] ^
+            t[1][(high >> 16u) & 0xFFu] ^ t[0][high >> 24u];
+    }
+    for (; size != 0; ++data, --size) {
+      reg = (reg >> 8u) ^ t[0][(reg ^ *data) & 0xFFu];
+    }
+  } else {
+    for (; size >= 8u; data += 8u, size -= 8u) {
+      uint64_t word = impl::loadBE64(data);
+      uint32_t high = reg ^ static_cast<uint32_t>(word >> 32u);
+      uint32_t low = static_cast<uint32_t>(word);
+      reg = t[7][high >> 24u] ^ t[6][(high >> 16u) & 0xFFu] ^ t[5][(high >> 8u) & 0xFFu] ^
+            t[4][high & 0xFFu] ^ t[3][low >> 24u] ^ t[2][(low >> 16u) & 0xFFu] ^
+            t[1][(low >> 8u) & 0xFFu] ^ t[0][low & 0xFFu];
+    }
+    for (; size != 0; ++data, --size) {
+      reg = (reg << 8u) ^ t[0][(reg >> 24u) ^ *data];
+    }
+  }
+  m_register = reg;
+}
+
+void CCrc::updateBit(uint32_t bit) {
+  if (m_params.reflected) {
+    uint32_t polynomial = reflect(m_params.polynomial, m_params.nofBits);
+    m_register ^= bit;
+    m_register = (m_register & 1u) ? (m_register >> 1u) ^ polynomial : m_register >> 1u;
+  } else {
+    uint32_t polynomial = m_params.polynomial << (32u - m_params.nofBits);
+    m_register ^= bit << 31u;
+    m_register = (m_register & 0x80000000u) ? (m_register << 1u) ^ polynomial : m_register << 1u;
+  }
+}
+
+void CCrc::updateBits(uint64_t bits, uint32_t nnofBits) {
+  ILO_ASSERT_WITH(nnofBits <= 64u, std::invalid_argument, "Number of bits must be 0 to 64.");
+  uint32_t nofFullBytes = nnofBits / 8u;
+  uint32_t nofTailBits = nnofBits % 8u;
+  for (uint32_t i = 0; i < nofFullBytes; ++i) {
+    uint8_t byte = static_cast<uint8_t>(bits >> (nnofBits - 8u * (i + 1u)));
+    update(&byte, 1u);
+  }
+  for (uint32_t i = 0; i < nofTailBits; ++i) {
+    // the bits of a partial group are processed in the order of the bits of a byte
+    uint32_t shift = m_params.reflected ? i : nofTailBits - 1u - i;
+    updateBit(static_cast<uint32_t>(bits >> shift) & 1u);
+  }
+}
+
+uint32_t CCrc::value() const {
+  uint32_t reg = m_params.reflected ? m_register : m_register >> (32u - m_params.nofBits);
+  return reg ^ m_params.xorOut;
+}
+}  // namespace ilo
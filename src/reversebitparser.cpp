@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+// Internal includes
+#include "ilo/reversebitparser.h"
+#include "ilo_logging.h"
+
+namespace ilo {
+template <typename PosT, typename BitOrderT>
+CBasicReverseBitParser<PosT, BitOrderT>::CBasicReverseBitParser(const ByteBuffer& externalBuffer,
+                                                                PosT nofValidBits)
+    : CBasicReverseBitParser(externalBuffer.data(),
+                             nofValidBits != 0 ? nofValidBits
+                                               : static_cast<PosT>(externalBuffer.size()) * 8u) {}
+
+template <typename PosT, typename BitOrderT>
+CBasicReverseBitParser<PosT, BitOrderT>::CBasicReverseBitParser(const uint8_t* buffer,
+                                                                PosT nofValidBits)
+    : m_state(),
+      m_nofValidBits(nofValidBits),
+      m_errorMode(EErrorMode::exception),
+      m_error(EBitError::none) {
+  m_state.buffer = buffer;
+  m_state.reset(nofValidBits);
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicReverseBitParser<PosT, BitOrderT>::seek(OffsetType bitposition,
+                                                   ilo::EPosType fromPosition) {
+  OffsetType bitOffset = 0;
+  switch (fromPosition) {
+    case ilo::EPosType::begin:
+      bitOffset = bitposition;
+      break;
+    case ilo::EPosType::cur:
+      bitOffset = static_cast<OffsetType>(m_state.pos) + bitposition;
+      break;
+    case ilo::EPosType::end:
+      bitOffset = static_cast<OffsetType>(m_nofValidBits) + bitposition;
+      break;
+    default:
+      seekFailed(EBitError::invalidPosition, "Invalid seeking position found.");
+      return;
+  }
+  if (bitOffset < 0) {
+    seekFailed(EBitError::invalidPosition, "Seek to negative position.");
+    return;
+  }
+  if (static_cast<PosT>(bitOffset) > m_nofValidBits) {
+    seekFailed(EBitError::invalidPosition, "Seeking out of range.");
+    return;
+  }
+  m_state.reset(static_cast<PosT>(bitOffset));
+}
+
+template <typename PosT, typename BitOrderT>
+uint64_t CBasicReverseBitParser<PosT, BitOrderT>::readFailed(PosT nnofBits, PosT maxNofBits) {
+  bool endOfData = nnofBits > m_state.pos;
+  if (m_errorMode == EErrorMode::latch) {
+    if (m_error == EBitError::none) {
+      m_error = endOfData ? EBitError::endOfData : EBitError::invalidNofBits;
+    }
+    return 0;
+  }
+
+  ILO_ASSERT_WITH(!endOfData, ReadException, "Not enough data left to parse.");
+  ILO_ASSERT_WITH(nnofBits <= maxNofBits, ReadException,
+                  "Number of bits does not fit into the given variable");
+  return 0;
+}
+
+template <typename PosT, typename BitOrderT>
+void CBasicReverseBitParser<PosT, BitOrderT>::seekFailed(EBitError error, const char* msg) {
+  if (m_errorMode == EErrorMode::latch) {
+    if (m_error == EBitError::none) {
+      m_error = error;
+    }
+    return;
+  }
+  ILO_FAIL_WITH(SeekException, "%s", msg);
+}
+
+template class CBasicReverseBitParser<uint32_t, SMsbFirst>;
+template class CBasicReverseBitParser<uint64_t, SMsbFirst>;
+template class CBasicReverseBitParser<uint32_t, SLsbFirst>;
+template class CBasicReverseBitParser<uint64_t, SLsbFirst>;
+}  // namespace ilo
@@ -0,0 +1,176 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+// System includes
+#include <cstring>
+#include <stdexcept>
+
+// Internal includes
+#include "ilo/syncscanner.h"
+#include "ilo/bittool_utils.h"
+#include "ilo_logging.h"
+
+namespace ilo {
+CSyncWordScanner::CSyncWordScanner(uint32_t syncWord, uint32_t nofBytes, uint32_t mask)
+    : m_syncWord(0), m_mask(0), m_nofBytes(nofBytes), m_anchorIndex(nofBytes), m_anchorValue(0) {
+  ILO_ASSERT_WITH(nofBytes >= 1u && nofBytes <= 4u, std::invalid_argument,
+                  "Sync word must have 1 to 4 bytes.");
+  uint32_t unusedBits = 32u - 8u * nofBytes;
+  ILO_ASSERT_WITH(nofBytes == 4u || (syncWord >> (8u * nofBytes)) == 0, std::invalid_argument,
+                  "Sync word exceeds the given number of bytes.");
+  m_mask = (mask << unusedBits) & (0xFFFFFFFFu << unusedBits);
+  m_syncWord = (syncWord << unusedBits) & m_mask;
+
+  for (uint32_t i = 0; i < nofBytes; ++i) {
+    uint32_t shift = 24u - 8u * i;
+    if (((m_mask >> shift) & 0xFFu) != 0xFFu) {
+      continue;
+    }
+    uint8_t value = static_cast<uint8_t>(m_syncWord >> shift);
+    bool isRare = value != 0x00u && value != 0xFFu;
+    if (m_anchorIndex == nofBytes || isRare) {
+      m_anchorIndex = i;
+      m_anchorValue = value;
+      if (isRare) {
+        break;
+      }
+    }
+  }
+}
+
+bool CSyncWordScanner::matchesAt(const uint8_t* data, size_t size, size_t offset) const {
+  uint64_t word = (offset + 8u <= size) ? impl::loadBE64(data + offset)
+                                        : impl::loadTailBE64(data, size, offset);
+  return ((static_cast<uint32_t>(word >> 32u) ^ m_syncWord) & m_mask) == 0;
+}
+
+size_t CSyncWordScanner::findNext(const uint8_t* data, size_t size, size_t fromOffset) const {
+  if (fromOffset > size || size - fromOffset < m_nofBytes) {
+    return size;
+  }
+  size_t lastOffset = size - m_nofBytes;
+
+  if (m_anchorIndex == m_nofBytes) {
+    // no byte has to match completely, test every offset
+    for (size_t offset = fromOffset; offset <= lastOffset; ++offset) {
+      if (matchesAt(data, size, offset)) {
+        return offset;
+      }
+    }
+    return size;
+  }
+
+  const uint8_t* scan = data + fromOffset + m_anchorIndex;
+  const uint8_t* scanEnd = data + lastOffset + m_anchorIndex + 1u;
+  while (scan < scanEnd) {
+    const void* hit = std::memchr(scan, m_anchorValue, static_cast<size_t>(scanEnd - scan));
+    if (hit == nullptr) {
+      break;
+    }
+    const uint8_t* anchor = static_cast<const uint8_t*>(hit);
+    size_t offset = static_cast<size_t>(anchor - data) - m_anchorIndex;
+    if (matchesAt(data, size, offset)) {
+      return offset;
+    }
+    scan = anchor + 1;
+  }
+  return size;
+}
+
+size_t CSyncWordScanner::findNext(const ByteBuffer& buffer, size_t fromOffset) const {
+  return findNext(buffer.data(), buffer.size(), fromOffset);
+}
+
+std::vector<size_t> CSyncWordScanner::findAll(const uint8_t* data, size_t size) const {
+  std::vector<size_t> offsets;
+  for (size_t offset = findNext(data, size, 0); offset != size;
+       offset = findNext(data, size, offset + 1u)) {
+    offsets.push_back(offset);
+  }
+  return offsets;
+}
+
+std::vector<size_t> CSyncWordScanner::findAll(const ByteBuffer& buffer) const {
+  return findAll(buffer.data(), buffer.size());
+}
+}  // namespace ilo
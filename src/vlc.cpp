@@ -0,0 +1,211 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2020 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+
+// System includes
+#include <algorithm>
+#include <stdexcept>
+
+// Internal includes
+#include "ilo/vlc.h"
+#include "ilo_logging.h"
+
+namespace ilo {
+CVlcTable::CVlcTable(const SVlcCode* codes, size_t nofCodes, uint32_t rootBits) {
+  init(codes, nofCodes, rootBits);
+}
+
+CVlcTable::CVlcTable(const std::vector<SVlcCode>& codes, uint32_t rootBits) {
+  init(codes.data(), codes.size(), rootBits);
+}
+
+void CVlcTable::init(const SVlcCode* codes, size_t nofCodes, uint32_t rootBits) {
+  ILO_ASSERT_WITH(nofCodes != 0 && codes != nullptr, std::invalid_argument, "Codebook is empty.");
+  ILO_ASSERT_WITH(rootBits >= 1u && rootBits <= 16u, std::invalid_argument,
+                  "Number of root table bits must be between 1 and 16.");
+
+  m_maxCodeBits = 0;
+  for (size_t i = 0; i < nofCodes; ++i) {
+    const SVlcCode& code = codes[i];
+    ILO_ASSERT_WITH(code.nofBits >= 1u && code.nofBits <= kMaxCodeBits, std::invalid_argument,
+                    "Codeword length must be between 1 and 32 bits.");
+    ILO_ASSERT_WITH(code.nofBits == 32u || (code.code >> code.nofBits) == 0, std::invalid_argument,
+                    "Codeword has more bits set than its length allows.");
+    m_maxCodeBits = std::max(m_maxCodeBits, code.nofBits);
+  }
+  m_rootBits = std::min(rootBits, m_maxCodeBits);
+
+  // root table, followed by the tables of the further levels
+  std::vector<const SVlcCode*> allCodes(nofCodes);
+  for (size_t i = 0; i < nofCodes; ++i) {
+    allCodes[i] = &codes[i];
+  }
+  m_decodeTable.clear();
+  buildTable(allCodes, 0, m_rootBits);
+
+  // encoder: sorted codebook and, for reasonably dense values, a table indexed by value
+  m_sortedCodes.assign(codes, codes + nofCodes);
+  std::sort(m_sortedCodes.begin(), m_sortedCodes.end(),
+            [](const SVlcCode& lhs, const SVlcCode& rhs) { return lhs.value < rhs.value; });
+  for (size_t i = 1; i < m_sortedCodes.size(); ++i) {
+    ILO_ASSERT_WITH(m_sortedCodes[i - 1].value != m_sortedCodes[i].value, std::invalid_argument,
+                    "Codebook contains a value more than once.");
+  }
+  m_minValue = m_sortedCodes.front().value;
+  int64_t valueRange = int64_t{m_sortedCodes.back().value} - m_minValue + 1;
+  m_denseEncodeTable.clear();
+  if (valueRange <= 4 * static_cast<int64_t>(nofCodes) + 256) {
+    m_denseEncodeTable.assign(static_cast<size_t>(valueRange), SVlcCode{0, 0, 0});
+    for (const SVlcCode& code : m_sortedCodes) {
+      m_denseEncodeTable[static_cast<size_t>(int64_t{code.value} - m_minValue)] = code;
+    }
+  }
+}
+
+size_t CVlcTable::buildTable(std::vector<const SVlcCode*>& codes, uint32_t usedBits,
+                             uint32_t tableBits) {
+  size_t tableOffset = m_decodeTable.size();
+  m_decodeTable.resize(tableOffset + (size_t{1} << tableBits), impl::SVlcEntry{0, 0, 0});
+
+  // direct hits for codewords ending in this table
+  auto longCodesBegin = std::partition(codes.begin(), codes.end(), [&](const SVlcCode* code) {
+    return code->nofBits <= usedBits + tableBits;
+  });
+  for (auto it = codes.begin(); it != longCodesBegin; ++it) {
+    fill(**it, tableOffset, tableBits, usedBits);
+  }
+
+  // longer codewords are grouped by their index into this table and resolved by a next level
+  // table, which is indexed by at most m_rootBits bits to bound the table sizes
+  auto tableIndex = [&](const SVlcCode* code) {
+    uint32_t shift = code->nofBits - usedBits - tableBits;
+    return static_cast<size_t>((uint64_t{code->code} >> shift) & ((uint64_t{1} << tableBits) - 1u));
+  };
+  std::vector<const SVlcCode*> longCodes(longCodesBegin, codes.end());
+  std::sort(longCodes.begin(), longCodes.end(), [&](const SVlcCode* lhs, const SVlcCode* rhs) {
+    return tableIndex(lhs) < tableIndex(rhs);
+  });
+  auto groupBegin = longCodes.begin();
+  while (groupBegin != longCodes.end()) {
+    size_t index = tableIndex(*groupBegin);
+    ILO_ASSERT_WITH(m_decodeTable[tableOffset + index].nofBits == 0, std::invalid_argument,
+                    "Codebook is not prefix-free.");
+    auto groupEnd = groupBegin;
+    uint32_t maxNofBits = 0;
+    while (groupEnd != longCodes.end() && tableIndex(*groupEnd) == index) {
+      maxNofBits = std::max(maxNofBits, (*groupEnd)->nofBits);
+      ++groupEnd;
+    }
+    std::vector<const SVlcCode*> group(groupBegin, groupEnd);
+    uint32_t subTableBits = std::min(maxNofBits - usedBits - tableBits, m_rootBits);
+    size_t subTableOffset = buildTable(group, usedBits + tableBits, subTableBits);
+    m_decodeTable[tableOffset + index] = impl::SVlcEntry{static_cast<int32_t>(subTableOffset), 0,
+                                                         static_cast<uint8_t>(subTableBits)};
+    groupBegin = groupEnd;
+  }
+  return tableOffset;
+}
+
+void CVlcTable::fill(const SVlcCode& code, size_t tableOffset, uint32_t tableBits,
+                     uint32_t usedBits) {
+  // all entries whose index starts with the (remaining) codeword bits decode to this codeword
+  uint32_t nofIndexBits = code.nofBits - usedBits;
+  uint64_t index = uint64_t{code.code} & ((uint64_t{1} << nofIndexBits) - 1u);
+  size_t first = tableOffset + static_cast<size_t>(index << (tableBits - nofIndexBits));
+  size_t count = size_t{1} << (tableBits - nofIndexBits);
+  for (size_t i = first; i < first + count; ++i) {
+    ILO_ASSERT_WITH(m_decodeTable[i].nofBits == 0 && m_decodeTable[i].subTableBits == 0,
+                    std::invalid_argument, "Codebook is not prefix-free.");
+    m_decodeTable[i] = impl::SVlcEntry{code.value, static_cast<uint8_t>(code.nofBits), 0};
+  }
+}
+
+const SVlcCode* CVlcTable::findSorted(int32_t value) const {
+  auto it = std::lower_bound(
+      m_sortedCodes.begin(), m_sortedCodes.end(), value,
+      [](const SVlcCode& code, int32_t searchValue) { return code.value < searchValue; });
+  if (it == m_sortedCodes.end() || it->value != value) {
+    return nullptr;
+  }
+  return &*it;
+}
+}  // namespace ilo